@@ -10,10 +10,18 @@
 #include <string>
 #include <vector>
 
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
 // software prefetch
 #include <immintrin.h>
 
-template <std::uint32_t Arity>
+#include "heap_key_traits.h"
+#include "heap_memory.h"
+#include "minheap_simd.h"
+
+template <std::uint32_t Arity, class Key = int, class Payload = void>
 class MinHeapT
 {
     using uint32_t = std::uint32_t;
@@ -21,24 +29,36 @@ class MinHeapT
 public:
     // heap shape (compile-time)
     static constexpr uint32_t arity = Arity;
+    static_assert(arity >= 2u, "arity must be >= 2");
+
+    using key_type = Key;
+    using payload_type = Payload;
+    static constexpr bool has_payload = !std::is_void_v<Payload>;
+    // kernel of the min-child scan (minheap_simd::isa, or "scalar" where
+    // this key type and arity have none)
+    static constexpr const char* simd = minheap_simd::kernel<typename heap_key_traits<Key>::encoded_type, Arity>;
 
 private:
+    using traits = heap_key_traits<Key>;
+    using enc_type = typename traits::encoded_type;
 
-    static constexpr std::size_t heap_alignment = 64;
-
-    struct HeapDeleter
-    {
-        void operator()(int* p) const noexcept
-        {
-            ::operator delete[](p, std::align_val_t(heap_alignment));
-        }
-    };
+    // placeholder so that payload members can be declared unconditionally
+    struct no_payload {};
+    using payload_slot = std::conditional_t<has_payload, Payload, no_payload>;
 
     const int maxDepth;
-    const uint32_t capacity;
-    std::unique_ptr<int[], HeapDeleter> heap;
+    // most elements the heap can ever hold
+    const uint32_t limit;
+    // elements it can hold before committing more memory (== limit when fixed)
+    uint32_t capacity;
+
+    // keys and payloads live in separate arrays so that the sift loops
+    // only ever pull key cache lines; payloads move once per level.
+    heap_array<enc_type> heap;
+    heap_array<payload_slot> payloads;
 
-    int root{};
+    enc_type root{};
+    payload_slot rootPayload{};
 
     uint32_t size_{0u};
 
@@ -78,6 +98,24 @@ private:
         return static_cast<uint32_t>(cap);
     }
 
+    // commit more of a growable heap's reservation; false when at the limit
+    __attribute__((noinline, cold)) bool grow()
+    {
+        if (capacity == limit)
+            return false;
+        const uint64_t want = std::min<uint64_t>(limit, std::max<uint64_t>(4096u, uint64_t(capacity) * 2u));
+        if (!heap.grow(want))
+            return false;
+        uint64_t got = std::min<uint64_t>(limit, heap.capacity());
+        if constexpr (has_payload) {
+            if (!payloads.grow(want))
+                return false;
+            got = std::min<uint64_t>(got, payloads.capacity());
+        }
+        capacity = static_cast<uint32_t>(got);
+        return true;
+    }
+
     static inline __attribute__((always_inline)) uint32_t parent(uint32_t idx)
     {
         // nodes stored in `heap[]` are indexed in level order
@@ -98,13 +136,28 @@ private:
                         _MM_HINT_T2;
 
 public:
+    static constexpr uint32_t default_reserve = static_cast<uint32_t>(std::numeric_limits<int>::max());
+
     explicit MinHeapT(int maxDepth) :
-        maxDepth(maxDepth), capacity(calcCapacity(maxDepth)),
-        heap(static_cast<int*>(::operator new[](sizeof(int) * capacity, std::align_val_t(heap_alignment))))
+        maxDepth(maxDepth), limit(calcCapacity(maxDepth)), capacity(limit),
+        heap(capacity)
     {
+        if constexpr (has_payload)
+            payloads = heap_array<payload_slot>(capacity);
         assert(maxDepth >= 0);
     }
 
+    // growable heap: reserve address space for `maxElements` up front and
+    // commit it page by page as the heap grows (no realloc, no copy).
+    explicit MinHeapT(heap_growable_t, uint32_t maxElements = default_reserve,
+                      heap_pages pages = heap_pages::small) :
+        maxDepth(-1), limit(maxElements), capacity(0u),
+        heap(heap_growable, maxElements, pages)
+    {
+        if constexpr (has_payload)
+            payloads = heap_array<payload_slot>(heap_growable, maxElements, pages);
+    }
+
     std::string name() const { return "MinHeap"; }
 
     static bool isPowerOfTwo(unsigned n) { return n > 0 && (n & n - 1) == 0; }
@@ -138,7 +191,7 @@ public:
     }
 
     inline __attribute__((always_inline)) bool isEmpty() const noexcept { return size_ == 0u; }
-    inline __attribute__((always_inline)) bool isFull() const noexcept { return size_ == capacity; }
+    inline __attribute__((always_inline)) bool isFull() const noexcept { return size_ == limit; }
     inline bool empty() const noexcept { return isEmpty(); }
 
     // number of elements currently in the heap
@@ -146,9 +199,17 @@ public:
     std::size_t size() const noexcept { return size_; }
 
     // maximum number of elements the heap can hold
-    int getCapacity() const noexcept { return static_cast<int>(capacity); }
+    int getCapacity() const noexcept { return static_cast<int>(limit); }
+
+    bool isGrowable() const noexcept { return !heap.memory().isFixed(); }
+    heap_pages pageKind() const noexcept { return heap.memory().pageKind(); }
+    std::size_t committedBytes() const noexcept
+    {
+        return heap.memory().committedBytes() + payloads.memory().committedBytes();
+    }
 
-    const int* data() const noexcept { return heap.get(); }
+    // encoded keys of the non-root nodes in level order
+    const enc_type* data() const noexcept { return heap.get(); }
 
     bool validateHeapProperty() const
     {
@@ -157,7 +218,7 @@ public:
 
         const uint32_t nonRootCount = size_ - 1u;
         for (uint32_t c = 0u; c < nonRootCount; ++c) {
-            const int cv = heap[c];
+            const enc_type cv = heap[c];
             if (c < arity) {
                 if (root > cv)
                     return false;
@@ -170,11 +231,14 @@ public:
         return true;
     }
 
-    bool push(int v)
+    template <bool P = has_payload, std::enable_if_t<!P, int> = 0>
+    bool push(Key k)
     {
-        if (isFull())
+        if (size_ == capacity && !grow())
             return false;
 
+        enc_type v = traits::encode(k);
+
         if (size_ == 0u) {
             root = v;
             size_ = 1u;
@@ -183,7 +247,7 @@ public:
 
         // insert at the end of the rootless array.
         uint32_t idx = size_ - 1u, p;
-        int pv;
+        enc_type pv;
         heap[idx] = v;
         ++size_;
 
@@ -232,24 +296,73 @@ public:
         return true;
     }
 
-    int top() const
+    template <bool P = has_payload, std::enable_if_t<P, int> = 0>
+    bool push(Key k, payload_slot pl)
+    {
+        if (size_ == capacity && !grow())
+            return false;
+
+        const enc_type v = traits::encode(k);
+
+        if (size_ == 0u) {
+            root = v;
+            rootPayload = std::move(pl);
+            size_ = 1u;
+            return true;
+        }
+
+        // payloads cannot ride along the branchless min/max lifting, so
+        // move a hole up instead and write key and payload once at the end.
+        uint32_t idx = size_ - 1u;
+        ++size_;
+
+        enc_type* __restrict h = heap.get();
+        payload_slot* __restrict pp = payloads.get();
+
+        while (idx >= arity) {
+            const uint32_t p = parent(idx);
+            if (v >= h[p])
+                break;
+            h[idx] = h[p];
+            pp[idx] = std::move(pp[p]);
+            idx = p;
+        }
+
+        if (v < root) {
+            h[idx] = root;
+            pp[idx] = std::move(rootPayload);
+            root = v;
+            rootPayload = std::move(pl);
+        } else {
+            h[idx] = v;
+            pp[idx] = std::move(pl);
+        }
+
+        return true;
+    }
+
+    Key top() const
     {
         if (isEmpty())
             throw std::runtime_error("empty heap");
 
-        return root;
+        return traits::decode(root);
     }
 
-    template <bool Condition, class V, class I>
-    inline __attribute__((always_inline)) void update_best_if(const V* __restrict heapPtr, I i, I& b, V& bv) noexcept
+    template <bool P = has_payload, std::enable_if_t<P, int> = 0>
+    const payload_slot& top_payload() const
     {
-        if constexpr (Condition) {
-            const V v = heapPtr[i];
-            if (v < bv) {
-                b = i;
-                bv = v;
-            }
-        }
+        if (isEmpty())
+            throw std::runtime_error("empty heap");
+
+        return rootPayload;
+    }
+
+    // pick the min among the full children block heap[first .. first+arity-1]
+    inline __attribute__((always_inline)) void select_min_child(const enc_type* __restrict h, uint32_t first,
+                                                                uint32_t& best, enc_type& bestVal) noexcept
+    {
+        best = first + minheap_simd::block_min<arity>(h + first, bestVal);
     }
 
     bool pop()
@@ -263,15 +376,18 @@ public:
         // if we popped the root from a 2-element heap, promote the only child.
         if (size_ == 1u) {
             root = heap[0u];
+            if constexpr (has_payload)
+                rootPayload = std::move(payloads[0u]);
             return true;
         }
 
         // move the last element into the root and sift down
         const uint32_t nonRootCount = size_ - 1u;
-        int v = heap[nonRootCount];
+        enc_type v = heap[nonRootCount];
 
-        // hoist pointer once (avoid repeated heap.get())
-        int* __restrict h = heap.get();
+        // hoist pointers once (avoid repeated heap.get())
+        enc_type* __restrict h = heap.get();
+        payload_slot* __restrict pp = payloads.get();
 
         auto prefetch_children_block = [&](uint32_t node) noexcept {
             // Prefetch the children block of `node` (one cache line in your layout).
@@ -280,36 +396,36 @@ public:
 
         // root step: choose the min among root's children at heap[0..arity-1].
         uint32_t best = 0u;
-        int bestVal = heap[0u];
+        enc_type bestVal = heap[0u];
 
         if (nonRootCount < arity) {
             for (uint32_t i = 1u; i < nonRootCount; ++i)
                 if (heap[i] < bestVal)
                     bestVal = heap[i], best = i;
         } else {
-            // unroll the first arity comparisons
-            update_best_if<true>(h, 1u, best, bestVal);
-            update_best_if<arity >= 4u>(h, 2u, best, bestVal);
-            update_best_if<arity >= 4u>(h, 3u, best, bestVal);
-            update_best_if<arity >= 8u>(h, 4u, best, bestVal);
-            update_best_if<arity >= 8u>(h, 5u, best, bestVal);
-            update_best_if<arity >= 8u>(h, 6u, best, bestVal);
-            update_best_if<arity >= 8u>(h, 7u, best, bestVal);
+            // full block: one SIMD kernel or the unrolled scalar chain
+            select_min_child(h, 0u, best, bestVal);
         }
 
         // if the last element is smaller than the min child, we're done
         if (v <= bestVal) {
             root = v;
+            if constexpr (has_payload)
+                rootPayload = std::move(pp[nonRootCount]);
             return true;
         }
 
         // promote the min child to the root
         root = bestVal;
         uint32_t hole = best;
+        if constexpr (has_payload)
+            rootPayload = std::move(pp[hole]);
 
         // if there are no grandchildren, the hole cannot have children.
         if (nonRootCount <= arity) {
             heap[hole] = v;
+            if constexpr (has_payload)
+                pp[hole] = std::move(pp[nonRootCount]);
             return true;
         }
 
@@ -334,14 +450,7 @@ public:
                     if (heap[i] < bestVal)
                         bestVal = heap[i], best = i;
             } else {
-                // unroll the comparisons
-                update_best_if<true>(h, first + 1u, best, bestVal);
-                update_best_if<arity >= 4u>(h, first + 2u, best, bestVal);
-                update_best_if<arity >= 4u>(h, first + 3u, best, bestVal);
-                update_best_if<arity >= 8u>(h, first + 4u, best, bestVal);
-                update_best_if<arity >= 8u>(h, first + 5u, best, bestVal);
-                update_best_if<arity >= 8u>(h, first + 6u, best, bestVal);
-                update_best_if<arity >= 8u>(h, first + 7u, best, bestVal);
+                select_min_child(h, first, best, bestVal);
             }
 
             // path-only prefetch: after selecting `best`, prefetch `best`'s children block
@@ -354,17 +463,497 @@ public:
                 break;
 
             h[hole] = bestVal;
+            if constexpr (has_payload)
+                pp[hole] = std::move(pp[best]);
             hole = best;
         }
 
         h[hole] = v;
+        if constexpr (has_payload)
+            pp[hole] = std::move(pp[nonRootCount]);
+
+        return true;
+    }
+
+    // replace the minimum by k: one sift-down from the root instead of a
+    // pop and a push; an empty heap just takes k
+    template <bool P = has_payload, std::enable_if_t<!P, int> = 0>
+    bool replace_top(Key k)
+    {
+        if (isEmpty())
+            return push(k);
+
+        const enc_type v = traits::encode(k);
+        if (size_ == 1u) {
+            root = v;
+            return true;
+        }
+
+        const uint32_t nonRootCount = size_ - 1u;
+        uint32_t best = 0u;
+        enc_type bestVal = heap[0u];
+        if (nonRootCount < arity) {
+            for (uint32_t i = 1u; i < nonRootCount; ++i)
+                if (heap[i] < bestVal)
+                    bestVal = heap[i], best = i;
+        } else {
+            select_min_child(heap.get(), 0u, best, bestVal);
+        }
 
+        if (v <= bestVal) {
+            root = v;
+            return true;
+        }
+        root = bestVal;
+        siftDownHole(best, v, nonRootCount);
         return true;
     }
+
+    // a batch at least this many times the current size is appended and
+    // heapified bottom-up (Floyd, O(size + n)) instead of pushed one by one
+    static constexpr uint32_t bulk_rebuild_ratio = 1u;
+
+    // push n keys; all or nothing, false when they would not fit
+    template <bool P = has_payload, std::enable_if_t<!P, int> = 0>
+    bool push_bulk(const Key* src, std::size_t n)
+    {
+        if (n == 0u)
+            return true;
+        if (n > limit - size_)
+            return false;
+
+        if (n < uint64_t(size_) * bulk_rebuild_ratio) {
+            for (std::size_t k = 0u; k < n; ++k)
+                push(src[k]);
+            return true;
+        }
+
+        while (capacity < size_ + n)
+            if (!grow())
+                return false;
+
+        // append behind the current elements; an empty heap takes its root from the batch
+        std::size_t k = 0u;
+        if (size_ == 0u) {
+            root = traits::encode(src[k++]);
+            size_ = 1u;
+        }
+        enc_type* __restrict h = heap.get();
+        uint32_t idx = size_ - 1u;
+        for (; k < n; ++k)
+            h[idx++] = traits::encode(src[k]);
+        size_ = idx + 1u;
+        heapify();
+        return true;
+    }
+
+    // pop up to n elements into out[] in ascending order; returns how many
+    template <bool P = has_payload, std::enable_if_t<!P, int> = 0>
+    std::size_t pop_n(Key* out, std::size_t n)
+    {
+        const std::size_t cnt = std::min<std::size_t>(n, size_);
+        for (std::size_t k = 0u; k < cnt; ++k) {
+            out[k] = traits::decode(root);
+            pop();
+        }
+        return cnt;
+    }
+
+private:
+    // sift v down from the hole `hole` of the rootless array
+    void siftDownHole(uint32_t hole, enc_type v, uint32_t nonRootCount) noexcept
+    {
+        enc_type* __restrict h = heap.get();
+        if (nonRootCount <= arity)
+            return (void)(h[hole] = v);
+
+        const uint32_t lastParent = parent(nonRootCount - 1u);
+        while (hole <= lastParent) {
+            const uint32_t first = child(hole);
+            uint32_t best;
+            enc_type bestVal;
+            if (nonRootCount - first < arity) {
+                best = first, bestVal = h[first];
+                for (uint32_t i = first + 1u; i < nonRootCount; ++i)
+                    if (h[i] < bestVal)
+                        bestVal = h[i], best = i;
+            } else {
+                select_min_child(h, first, best, bestVal);
+            }
+            if (v <= bestVal)
+                break;
+            h[hole] = bestVal;
+            hole = best;
+        }
+        h[hole] = v;
+    }
+
+    // Floyd's bottom-up build over root + heap[0 .. size_-2]
+    void heapify() noexcept
+    {
+        if (size_ <= 1u)
+            return;
+
+        enc_type* __restrict h = heap.get();
+        const uint32_t nonRootCount = size_ - 1u;
+
+        // every subtree below the root's children first ...
+        if (nonRootCount > arity) {
+            for (uint32_t idx = parent(nonRootCount - 1u) + 1u; idx-- > 0u;)
+                siftDownHole(idx, h[idx], nonRootCount);
+        }
+
+        // ... then the root against the min of its children block
+        uint32_t best = 0u;
+        enc_type bestVal = h[0u];
+        const uint32_t rootChildren = std::min(nonRootCount, arity);
+        for (uint32_t i = 1u; i < rootChildren; ++i)
+            if (h[i] < bestVal)
+                bestVal = h[i], best = i;
+        if (root <= bestVal)
+            return;
+        const enc_type v = root;
+        root = bestVal;
+        siftDownHole(best, v, nonRootCount);
+    }
+};
+
+// addressable variant for decrease-key algorithms (e.g. Dijkstra): elements
+// are ids in [0, maxId) and a position map tracks each id's heap slot, so
+// the heap holds at most one entry per id. Same rootless layout as MinHeapT.
+template <std::uint32_t Arity, class Key = int>
+class IndexedMinHeapT
+{
+    using uint32_t = std::uint32_t;
+
+public:
+    static constexpr uint32_t arity = Arity;
+    static_assert(arity >= 2u, "arity must be >= 2");
+
+    using key_type = Key;
+    static constexpr const char* simd = minheap_simd::kernel<typename heap_key_traits<Key>::encoded_type, Arity>;
+
+private:
+    using traits = heap_key_traits<Key>;
+    using enc_type = typename traits::encoded_type;
+
+    // position map sentinels
+    static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t at_root = absent - 1u;
+
+    const uint32_t maxId;
+    heap_array<enc_type> heap;
+    heap_array<uint32_t> ids;
+    heap_array<uint32_t> pos;
+
+    enc_type root{};
+    uint32_t rootId{};
+
+    uint32_t size_{0u};
+
+    static inline __attribute__((always_inline)) uint32_t parent(uint32_t idx) { return (idx / arity) - 1u; }
+    static inline __attribute__((always_inline)) uint32_t child(uint32_t idx) { return arity * (idx + 1u); }
+
+    // place (v, id) at the hole `idx` or above it, ending at the root if needed
+    inline __attribute__((always_inline)) void siftUp(uint32_t idx, enc_type v, uint32_t id) noexcept
+    {
+        enc_type* __restrict h = heap.get();
+        uint32_t* __restrict hid = ids.get();
+        uint32_t* __restrict hpos = pos.get();
+
+        while (idx >= arity) {
+            const uint32_t p = parent(idx);
+            if (v >= h[p])
+                break;
+            h[idx] = h[p];
+            hid[idx] = hid[p];
+            hpos[hid[idx]] = idx;
+            idx = p;
+        }
+
+        if (v < root) {
+            h[idx] = root;
+            hid[idx] = rootId;
+            hpos[rootId] = idx;
+            root = v;
+            rootId = id;
+            hpos[id] = at_root;
+        } else {
+            h[idx] = v;
+            hid[idx] = id;
+            hpos[id] = idx;
+        }
+    }
+
+public:
+    explicit IndexedMinHeapT(uint32_t maxId) :
+        maxId(maxId), heap(maxId), ids(maxId), pos(maxId)
+    {
+        std::fill_n(pos.get(), maxId, absent);
+    }
+
+    std::string name() const { return "IndexedMinHeap"; }
+
+    inline bool empty() const noexcept { return size_ == 0u; }
+    std::size_t size() const noexcept { return size_; }
+    uint32_t idLimit() const noexcept { return maxId; }
+
+    inline bool contains(uint32_t id) const noexcept { return pos[id] != absent; }
+
+    Key top() const
+    {
+        if (empty())
+            throw std::runtime_error("empty heap");
+        return traits::decode(root);
+    }
+
+    uint32_t top_id() const
+    {
+        if (empty())
+            throw std::runtime_error("empty heap");
+        return rootId;
+    }
+
+    // current key of an id that is in the heap
+    Key key_of(uint32_t id) const
+    {
+        assert(contains(id));
+        const uint32_t slot = pos[id];
+        return traits::decode(slot == at_root ? root : heap[slot]);
+    }
+
+    // insert an id that is not in the heap
+    bool push(uint32_t id, Key k)
+    {
+        assert(id < maxId && !contains(id));
+
+        const enc_type v = traits::encode(k);
+        if (size_ == 0u) {
+            root = v;
+            rootId = id;
+            pos[id] = at_root;
+            size_ = 1u;
+            return true;
+        }
+
+        const uint32_t idx = size_ - 1u;
+        ++size_;
+        siftUp(idx, v, id);
+        return true;
+    }
+
+    // lower the key of an id in the heap; `k` must not exceed its current key
+    void decrease_key(uint32_t id, Key k)
+    {
+        assert(contains(id));
+
+        const enc_type v = traits::encode(k);
+        const uint32_t slot = pos[id];
+        if (slot == at_root) {
+            assert(v <= root);
+            root = v;
+            return;
+        }
+        assert(v <= heap[slot]);
+        siftUp(slot, v, id);
+    }
+
+    // push when absent, decrease when `k` improves on the current key;
+    // returns true when the heap changed
+    bool push_or_decrease(uint32_t id, Key k)
+    {
+        if (!contains(id))
+            return push(id, k);
+        if (!(traits::encode(k) < traits::encode(key_of(id))))
+            return false;
+        decrease_key(id, k);
+        return true;
+    }
+
+    bool pop()
+    {
+        if (empty())
+            return false;
+
+        pos[rootId] = absent;
+
+        if (--size_ == 0u)
+            return true;
+
+        enc_type* __restrict h = heap.get();
+        uint32_t* __restrict hid = ids.get();
+        uint32_t* __restrict hpos = pos.get();
+
+        if (size_ == 1u) {
+            root = h[0u];
+            rootId = hid[0u];
+            hpos[rootId] = at_root;
+            return true;
+        }
+
+        const uint32_t nonRootCount = size_ - 1u;
+        const enc_type v = h[nonRootCount];
+        const uint32_t vid = hid[nonRootCount];
+
+        uint32_t best = 0u;
+        enc_type bestVal = h[0u];
+        if (nonRootCount < arity) {
+            for (uint32_t i = 1u; i < nonRootCount; ++i)
+                if (h[i] < bestVal)
+                    bestVal = h[i], best = i;
+        } else {
+            best = minheap_simd::block_min<arity>(h, bestVal);
+        }
+
+        if (v <= bestVal) {
+            root = v;
+            rootId = vid;
+            hpos[vid] = at_root;
+            return true;
+        }
+
+        root = bestVal;
+        rootId = hid[best];
+        hpos[rootId] = at_root;
+        uint32_t hole = best;
+
+        if (nonRootCount > arity) {
+            const uint32_t lastParent = parent(nonRootCount - 1u);
+            while (hole <= lastParent) {
+                const uint32_t first = child(hole);
+                const uint32_t remaining = nonRootCount - first;
+                if (remaining < arity) {
+                    best = first, bestVal = h[first];
+                    for (uint32_t i = first + 1u; i < nonRootCount; ++i)
+                        if (h[i] < bestVal)
+                            bestVal = h[i], best = i;
+                } else {
+                    best = first + minheap_simd::block_min<arity>(h + first, bestVal);
+                }
+
+                if (v <= bestVal)
+                    break;
+
+                h[hole] = bestVal;
+                hid[hole] = hid[best];
+                hpos[hid[hole]] = hole;
+                hole = best;
+            }
+        }
+
+        h[hole] = v;
+        hid[hole] = vid;
+        hpos[vid] = hole;
+        return true;
+    }
+};
+
+// bounded top-k selection: keeps the k largest keys offered so far in a
+// fixed-capacity MinHeapT, whose root is the k-th largest and so the
+// admission threshold. Once full, a key at or below the threshold is
+// rejected without touching the heap; offer_bulk tests `reject_block` keys
+// at a time against it (minheap_simd::block_above) and only the survivors
+// replace the root. Ties with the threshold are rejected.
+template <std::uint32_t Arity, class Key = int>
+class TopKHeapT
+{
+    using uint32_t = std::uint32_t;
+    using heap_type = MinHeapT<Arity, Key>;
+
+public:
+    static constexpr uint32_t arity = Arity;
+    using key_type = Key;
+    static constexpr const char* simd = heap_type::simd;
+
+    // keys per threshold mask; a block without survivors costs one branch
+    static constexpr uint32_t reject_block = 64u;
+
+    explicit TopKHeapT(uint32_t k) : k_(k), heap(heap_type::minDepthForSize(k)) {}
+
+    std::string name() const { return "TopKHeap"; }
+
+    inline bool empty() const noexcept { return heap.empty(); }
+    inline bool isFull() const noexcept { return heap.size() == k_; }
+    std::size_t size() const noexcept { return heap.size(); }
+    // k
+    std::size_t capacity() const noexcept { return k_; }
+
+    // smallest key kept, the one the next survivor replaces once full
+    Key threshold() const { return heap.top(); }
+
+    // offered keys that replaced the threshold
+    std::uint64_t replacements() const noexcept { return replaced; }
+
+    // keep x if it is among the k largest so far; false when rejected
+    bool offer(Key x)
+    {
+        if (heap.size() < k_)
+            return heap.push(x);
+        if (k_ == 0u || !(x > heap.top()))
+            return false;
+        heap.replace_top(x);
+        ++replaced;
+        return true;
+    }
+
+    void offer_bulk(const Key* src, std::size_t n)
+    {
+        // fill up to k first (bottom-up when the batch is large) ...
+        std::size_t i = 0u;
+        if (heap.size() < k_) {
+            i = std::min<std::size_t>(n, k_ - heap.size());
+            heap.push_bulk(src, i);
+        }
+        if (i == n || k_ == 0u)
+            return;
+
+        // ... then reject whole blocks; a survivor raises the threshold, so
+        // the remaining bits of its block are checked again one by one
+        Key t = heap.top();
+        for (; i + reject_block <= n; i += reject_block) {
+            std::uint64_t m = minheap_simd::block_above<reject_block>(src + i, t);
+            while (m) {
+                const Key x = src[i + static_cast<std::size_t>(__builtin_ctzll(m))];
+                m &= m - 1u;
+                if (x > t) {
+                    heap.replace_top(x);
+                    ++replaced;
+                    t = heap.top();
+                }
+            }
+        }
+        for (; i < n; ++i)
+            if (src[i] > t) {
+                heap.replace_top(src[i]);
+                ++replaced;
+                t = heap.top();
+            }
+    }
+
+    // the kept keys in descending order into out[0 .. size()-1]; returns how
+    // many and leaves the container empty
+    std::size_t take_sorted(Key* out)
+    {
+        const std::size_t cnt = heap.size();
+        for (std::size_t j = cnt; j-- > 0u;) {
+            out[j] = heap.top();
+            heap.pop();
+        }
+        return cnt;
+    }
+
+private:
+    const uint32_t k_;
+    heap_type heap;
+    std::uint64_t replaced{0u};
 };
 
+// arity 16 makes one children block of int keys exactly one 64-byte line
+// (8 for uint64/double keys); see minheap_simd.h for the block kernels.
 #ifndef NHPQ_MINHEAP_ARITY
 #define NHPQ_MINHEAP_ARITY 2u
 #endif
 
 using MinHeap = MinHeapT<NHPQ_MINHEAP_ARITY>;
+using IndexedMinHeap = IndexedMinHeapT<NHPQ_MINHEAP_ARITY, double>;
+using TopKHeap = TopKHeapT<NHPQ_MINHEAP_ARITY>;
@@ -0,0 +1,99 @@
+#ifndef BENCH_RECORD_H
+#define BENCH_RECORD_H
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// one benchmark result as a flat JSON object, printed on a single line
+// ("JSON lines"), so a sweep over many cells is one record per line.
+// Fields keep their insertion order; adding a key twice keeps both, the
+// reader sees the last one.
+class bench_record {
+    std::vector<std::pair<std::string, std::string>> fields;
+
+    static std::string quote(const char * s) {
+        std::string out = "\"";
+        for (; *s; s++) {
+            if (*s == '"' || *s == '\\')
+                out += '\\';
+            out += *s;
+        }
+        return out + "\"";
+    }
+
+    // exponent bits, since -ffast-math (the build uses -Ofast) folds
+    // std::isfinite to true
+    static bool finite(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return ((bits >> 52) & 0x7FF) != 0x7FF;
+    }
+
+public:
+    void add(const char * key, const char * value) {
+        fields.emplace_back(key, quote(value));
+    }
+
+    void add(const char * key, const std::string & value) {
+        add(key, value.c_str());
+    }
+
+    void add(const char * key, bool value) {
+        fields.emplace_back(key, value ? "true" : "false");
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    void add(const char * key, T value) {
+        char buf[64];
+        if constexpr (std::is_floating_point<T>::value) {
+            if (!finite(static_cast<double>(value)))
+                return add(key, "nan");
+            std::snprintf(buf, sizeof(buf), "%.6g", static_cast<double>(value));
+        } else if constexpr (std::is_signed<T>::value) {
+            std::snprintf(buf, sizeof(buf), "%" PRId64, static_cast<int64_t>(value));
+        } else {
+            std::snprintf(buf, sizeof(buf), "%" PRIu64, static_cast<uint64_t>(value));
+        }
+        fields.emplace_back(key, buf);
+    }
+
+    // fixed-point double, for values that must not lose digits to %g
+    void add_fixed(const char * key, double value, int decimals) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        fields.emplace_back(key, buf);
+    }
+
+    // numeric value of the last field `key`; false if absent or not a number
+    bool number(const char * key, double & out) const {
+        for (auto it = fields.rbegin(); it != fields.rend(); ++it) {
+            if (it->first != key)
+                continue;
+            char * end = nullptr;
+            out = std::strtod(it->second.c_str(), &end);
+            return end != it->second.c_str() && *end == '\0';
+        }
+        return false;
+    }
+
+    void print(FILE * out = stdout) const {
+        std::string line = "{";
+        for (size_t k = 0; k < fields.size(); k++) {
+            if (k)
+                line += ", ";
+            line += quote(fields[k].first.c_str()) + ": " + fields[k].second;
+        }
+        line += "}\n";
+        std::fputs(line.c_str(), out);
+        std::fflush(out);
+    }
+};
+
+#endif // BENCH_RECORD_H
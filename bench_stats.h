@@ -0,0 +1,67 @@
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// robust summaries of repeated timings: median, median absolute deviation
+// and a percentile-bootstrap confidence interval of the median. Medians
+// rather than means, because timing noise is one-sided (interrupts, page
+// faults and frequency changes only ever add time).
+namespace bench_stats {
+
+inline double median(std::vector<double> v) {
+    if (v.empty())
+        return NAN;
+    const size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    const double hi = v[mid];
+    if (v.size() % 2)
+        return hi;
+    return (hi + *std::max_element(v.begin(), v.begin() + mid)) / 2.0;
+}
+
+// median of |x - median(x)| (unscaled; multiply by 1.4826 for a normal sigma)
+inline double mad(const std::vector<double> & v) {
+    const double m = median(v);
+    std::vector<double> dev(v.size());
+    for (size_t k = 0; k < v.size(); k++)
+        dev[k] = std::fabs(v[k] - m);
+    return median(std::move(dev));
+}
+
+struct interval {
+    double lo;
+    double hi;
+};
+
+// two-sided `level` interval of the median from `resamples` bootstrap
+// resamples; seeded, so the same timings always give the same interval
+inline interval bootstrap_median_ci(const std::vector<double> & v, double level = 0.95,
+                                    unsigned resamples = 2000, uint64_t seed = 1) {
+    if (v.size() < 2)
+        return {NAN, NAN};
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, v.size() - 1);
+    std::vector<double> sample(v.size()), medians(resamples);
+    for (unsigned b = 0; b < resamples; b++) {
+        for (auto & x : sample)
+            x = v[pick(rng)];
+        medians[b] = median(sample);
+    }
+    std::sort(medians.begin(), medians.end());
+    const double tail = (1.0 - level) / 2.0;
+    const auto at = [&](double q) {
+        const size_t i = static_cast<size_t>(std::lround(q * (resamples - 1)));
+        return medians[std::min<size_t>(i, resamples - 1)];
+    };
+    return {at(tail), at(1.0 - tail)};
+}
+
+} // namespace bench_stats
+
+#endif // BENCH_STATS_H
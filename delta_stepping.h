@@ -0,0 +1,225 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "graph.h"
+#include "parallel_util.h"
+
+// parallel single-source shortest paths by delta-stepping (Meyer & Sanders).
+//
+// Tentative distances live in one array of atomic doubles and only ever go
+// down (CAS min). Nodes are kept in buckets of width delta; bucket i holds
+// nodes whose tentative distance is in [i*delta, (i+1)*delta). Every thread
+// owns its own set of buckets and files a node into them when *it* lowered
+// that node's distance, so inserts never synchronize.
+//
+// Bucket i is settled in light phases: all threads publish their part of
+// bucket i, the published frontier is split evenly across threads, and each
+// frontier node relaxes its light arcs (d <= delta), which may refill bucket
+// i. When bucket i stays empty, the heavy arcs of every node settled in it
+// are relaxed once. Entries whose distance has since dropped into another
+// bucket are skipped (they are re-filed there), so the final distances equal
+// sequential Dijkstra's for any thread count.
+class delta_stepping {
+
+public:
+    struct stats {
+        uint64_t relaxations = 0;    // successful distance updates (bucket inserts)
+        uint64_t stale_entries = 0;  // bucket entries skipped as outdated
+        uint64_t buckets = 0;        // non-empty buckets settled
+        uint64_t light_phases = 0;   // light-arc rounds over all buckets
+        uint64_t max_frontier = 0;   // largest single light-phase frontier
+    };
+
+private:
+    struct alignas(64) local {
+        std::vector<std::vector<int>> buckets; // indexed by absolute bucket number
+        std::vector<int> frontier;             // published part of the current bucket
+        std::vector<int> settled;              // nodes of the current bucket, for heavy arcs
+        size_t next_bucket = 0;
+        stats st;
+    };
+
+    static constexpr size_t no_bucket = std::numeric_limits<size_t>::max();
+
+    const Graph & g;
+    const double delta;
+    par::thread_pool pool;
+    par::spin_barrier barrier;
+    std::vector<std::atomic<double>> dist;
+    std::vector<std::atomic<uint64_t>> settled_in; // 1 + bucket a node was last settled in
+    std::vector<local> locals;
+
+    size_t bucket_of(double d) const {
+        return static_cast<size_t>(d / delta);
+    }
+
+    // lower dist[v] to d; the thread that wins files v in its own bucket
+    void relax(local & me, int v, double d) {
+        double cur = dist[v].load(std::memory_order_relaxed);
+        while (d < cur) {
+            if (dist[v].compare_exchange_weak(cur, d, std::memory_order_relaxed)) {
+                const size_t b = bucket_of(d);
+                if (b >= me.buckets.size())
+                    me.buckets.resize(b + 1);
+                me.buckets[b].push_back(v);
+                me.st.relaxations++;
+                return;
+            }
+        }
+    }
+
+    size_t first_bucket(const local & me, size_t from) const {
+        for (size_t b = from; b < me.buckets.size(); b++)
+            if (!me.buckets[b].empty())
+                return b;
+        return no_bucket;
+    }
+
+    size_t min_next_bucket() const {
+        size_t b = no_bucket;
+        for (const auto & l : locals)
+            b = std::min(b, l.next_bucket);
+        return b;
+    }
+
+    void work(unsigned t) {
+        const unsigned threads = pool.size();
+        local & me = locals[t];
+
+        me.next_bucket = first_bucket(me, 0);
+        barrier.arrive_and_wait();
+        for (size_t cur = min_next_bucket(); cur != no_bucket;) {
+            for (;;) {
+                me.frontier.clear();
+                if (cur < me.buckets.size())
+                    me.frontier.swap(me.buckets[cur]);
+                barrier.arrive_and_wait();
+
+                size_t total = 0;
+                for (const auto & l : locals)
+                    total += l.frontier.size();
+                if (total == 0)
+                    break;
+                if (t == 0) {
+                    me.st.light_phases++;
+                    me.st.max_frontier = std::max<uint64_t>(me.st.max_frontier, total);
+                }
+
+                // this thread's even share of the concatenated frontiers
+                const size_t lo = par::chunk_begin(total, threads, t);
+                const size_t hi = par::chunk_begin(total, threads, t + 1);
+                size_t base = 0;
+                for (const auto & l : locals) {
+                    const size_t n = l.frontier.size();
+                    const size_t b = std::max(lo, base), e = std::min(hi, base + n);
+                    for (size_t k = b; k < e; k++) {
+                        const int u = l.frontier[k - base];
+                        const double du = dist[u].load(std::memory_order_relaxed);
+                        if (bucket_of(du) != cur) {
+                            me.st.stale_entries++;
+                            continue;
+                        }
+                        if (settled_in[u].exchange(cur + 1, std::memory_order_relaxed) != cur + 1)
+                            me.settled.push_back(u);
+                        for (const auto & arc : g.neighbors(u))
+                            if (arc.d <= delta)
+                                relax(me, arc.to, du + arc.d);
+                    }
+                    base += n;
+                }
+                barrier.arrive_and_wait();
+            }
+
+            // bucket `cur` is final: relax the heavy arcs of its nodes once
+            for (const int u : me.settled) {
+                const double du = dist[u].load(std::memory_order_relaxed);
+                for (const auto & arc : g.neighbors(u))
+                    if (arc.d > delta)
+                        relax(me, arc.to, du + arc.d);
+            }
+            me.settled.clear();
+            if (t == 0)
+                me.st.buckets++;
+
+            me.next_bucket = first_bucket(me, cur + 1);
+            barrier.arrive_and_wait();
+            cur = min_next_bucket();
+            // nobody may overwrite next_bucket before every thread has read it
+            barrier.arrive_and_wait();
+        }
+    }
+
+public:
+    // the worker threads start here, so run() only pays for the search
+    delta_stepping(const Graph & g, unsigned threads, double delta) :
+        g(g), delta(delta), pool(threads), barrier(std::max(1u, threads)),
+        dist(g.node_num()), settled_in(g.node_num()), locals(std::max(1u, threads)) {}
+
+    // max arc weight / average degree, the Meyer & Sanders rule of thumb,
+    // but never below the lightest arc
+    static double default_delta(const Graph & g) {
+        if (g.edge_num() == 0)
+            return 1.0;
+        double lo = DBL_MAX, hi = 0.0;
+        for (size_t u = 0; u < g.node_num(); u++)
+            for (const auto & arc : g.neighbors(static_cast<int>(u))) {
+                lo = std::min(lo, arc.d);
+                hi = std::max(hi, arc.d);
+            }
+        const double avg_degree = 2.0 * g.edge_num() / g.node_num();
+        return std::max(lo, hi / avg_degree);
+    }
+
+    double bucket_width() const {
+        return delta;
+    }
+
+    unsigned threads() const {
+        return pool.size();
+    }
+
+    // distances from `source` into `out` (DBL_MAX where unreachable)
+    stats run(int source, std::vector<double> & out) {
+        const size_t n = g.node_num();
+        pool.run([&](unsigned t) {
+            const size_t b = par::chunk_begin(n, pool.size(), t), e = par::chunk_begin(n, pool.size(), t + 1);
+            for (size_t v = b; v < e; v++) {
+                dist[v].store(DBL_MAX, std::memory_order_relaxed);
+                settled_in[v].store(0, std::memory_order_relaxed);
+            }
+            locals[t] = local();
+        });
+        dist[source].store(0.0, std::memory_order_relaxed);
+        locals[0].buckets.resize(1);
+        locals[0].buckets[0].push_back(source);
+
+        pool.run([&](unsigned t) { work(t); });
+
+        out.resize(n);
+        pool.run([&](unsigned t) {
+            const size_t b = par::chunk_begin(n, pool.size(), t), e = par::chunk_begin(n, pool.size(), t + 1);
+            for (size_t v = b; v < e; v++)
+                out[v] = dist[v].load(std::memory_order_relaxed);
+        });
+
+        stats st;
+        for (const auto & l : locals) {
+            st.relaxations += l.st.relaxations;
+            st.stale_entries += l.st.stale_entries;
+            st.buckets += l.st.buckets;
+            st.light_phases += l.st.light_phases;
+            st.max_frontier = std::max(st.max_frontier, l.st.max_frontier);
+        }
+        return st;
+    }
+};
+
+#endif // DELTA_STEPPING_H
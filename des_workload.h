@@ -0,0 +1,144 @@
+#ifndef DES_WORKLOAD_H
+#define DES_WORKLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// TEST IV: discrete event simulation. The hold model of hold_model.h, but
+// every queued event carries a record of `Bytes` bytes that the handler reads
+// and updates when the event fires, the way a scheduler's event entries do.
+//
+// Where the record lives is the point of the comparison:
+//
+//   inline    the record is part of the queued element; implicit heaps move
+//             all of it on every sift step, node-based heaps never move it
+//   indirect  the element is (time, slot) and the records sit in one array,
+//             the slot of a fired event is reused by the event it schedules
+//   move      the element owns its record through a unique_ptr and is moved
+//             through the queue (queues that copy values cannot run it)
+//
+// The records are created when the queue is filled, after the memory
+// snapshot, so bytes_per_element covers them in every mode.
+namespace des {
+
+template <size_t Bytes>
+struct record {
+    static_assert(Bytes >= 8 && Bytes % sizeof(uint32_t) == 0, "records are whole 32-bit words, at least two");
+    uint32_t words[Bytes / sizeof(uint32_t)];
+};
+
+// a scheduled event, ordered by time only
+template <typename Body>
+struct event {
+    using body_type = Body;
+    int time;
+    Body body;
+
+    friend bool operator<(const event & a, const event & b) { return a.time < b.time; }
+    friend bool operator>(const event & a, const event & b) { return a.time > b.time; }
+};
+
+enum class store { inline_record, indirect, move };
+
+inline const char * const store_names[] = {"inline", "indirect", "move"};
+
+inline bool parse(const std::string & name, store & out) {
+    for (size_t k = 0; k < std::size(store_names); k++)
+        if (name == store_names[k]) {
+            out = static_cast<store>(k);
+            return true;
+        }
+    return false;
+}
+
+// record sizes the binary is built for
+inline constexpr size_t record_sizes[] = {8, 32, 64, 128};
+
+inline bool supported_size(size_t bytes) {
+    for (const size_t b : record_sizes)
+        if (b == bytes)
+            return true;
+    return false;
+}
+
+// every store makes the body of the i-th initial event and finds the record
+// behind a body
+
+template <size_t Bytes>
+struct inline_store {
+    using body = record<Bytes>;
+    static constexpr store kind = store::inline_record;
+
+    explicit inline_store(size_t) {}
+    body make(size_t i) {
+        body b{};
+        b.words[0] = static_cast<uint32_t>(i);
+        return b;
+    }
+    record<Bytes> & get(body & b) { return b; }
+};
+
+template <size_t Bytes>
+struct indirect_store {
+    struct body {
+        uint32_t slot;
+    };
+    static constexpr store kind = store::indirect;
+
+    std::vector<record<Bytes>> records;
+
+    explicit indirect_store(size_t n) : records(n) {}
+    body make(size_t i) {
+        records[i].words[0] = static_cast<uint32_t>(i);
+        return body{static_cast<uint32_t>(i)};
+    }
+    record<Bytes> & get(body & b) { return records[b.slot]; }
+};
+
+template <size_t Bytes>
+struct move_store {
+    using body = std::unique_ptr<record<Bytes>>;
+    static constexpr store kind = store::move;
+
+    explicit move_store(size_t) {}
+    body make(size_t i) {
+        body b = std::make_unique<record<Bytes>>();
+        b->words[0] = static_cast<uint32_t>(i);
+        return b;
+    }
+    record<Bytes> & get(body & b) { return *b; }
+};
+
+// the event handler: reads the whole record and writes one word back
+template <size_t Bytes>
+inline void handle(record<Bytes> & r, int time) {
+    uint32_t sum = static_cast<uint32_t>(time);
+    for (const uint32_t w : r.words)
+        sum = sum * 31u + w;
+    r.words[static_cast<uint32_t>(time) % std::size(r.words)] = sum;
+}
+
+// expose a keyed heap (key = time, payload = body) through the event
+// interface; take_top moves the payload out of the heap before popping
+template <typename Heap, typename Ev>
+struct keyed_event_queue : public Heap {
+    using Heap::Heap;
+
+    void push(Ev && e) { Heap::push(e.time, std::move(e.body)); }
+
+    Ev take_top() {
+        using body = typename Ev::body_type;
+        Ev e{Heap::top(), std::move(const_cast<body &>(Heap::top_payload()))};
+        Heap::pop();
+        return e;
+    }
+};
+
+} // namespace des
+
+#endif // DES_WORKLOAD_H
@@ -1,13 +1,16 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <cfloat>
+#include <cmath>
+#include <limits>
 #include <queue>
-#include <string>
-#include <map>
-#include <list>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 #include <assert.h>
 
 //define a strut of node measurement from source node S
@@ -61,39 +64,187 @@ struct compare_item
     }
 };
 
+//expose a keyed heap (key = dist_to_s, payload = node) through the NODE_M interface
+template <typename Heap>
+struct node_m_queue : public Heap
+{
+    using Heap::Heap;
+
+    using key_type = typename Heap::key_type;
+
+    //heaps keyed on integers need integral distances (TEST II weights are integers);
+    //checked in every build, a truncated key would silently break the order
+    auto push(const NODE_M &n) {
+        if constexpr (std::is_integral_v<key_type>) {
+            if (!(n.dist_to_s >= static_cast<double>(std::numeric_limits<key_type>::min()) &&
+                  n.dist_to_s <= static_cast<double>(std::numeric_limits<key_type>::max()) &&
+                  std::trunc(n.dist_to_s) == n.dist_to_s))
+                throw std::domain_error("node_m_queue: distance " + std::to_string(n.dist_to_s) +
+                                        " is not representable as an integer key");
+        }
+        return Heap::push(static_cast<key_type>(n.dist_to_s), n.node);
+    }
+    NODE_M top() const { return NODE_M(Heap::top_payload(), static_cast<double>(Heap::top())); }
+};
+
+//decrease-key frontier over a node-based heap with stable handles (boost
+//pairing_heap, pairing_heap_priqueue): one handle per graph node, exposing
+//the id interface of IndexedMinHeap (push/top_id/contains/decrease_key)
+template <typename Heap>
+class node_handle_queue
+{
+    template <typename H, typename = void>
+    struct has_decrease_key : std::false_type {};
+    template <typename H>
+    struct has_decrease_key<H, std::void_t<decltype(std::declval<H&>().decrease_key(
+        std::declval<typename H::handle_type>(), std::declval<NODE_M>()))>> : std::true_type {};
+
+    Heap heap;
+    std::vector<typename Heap::handle_type> handles;
+    std::vector<bool> queued;
+
+public:
+    explicit node_handle_queue(size_t node_num) : handles(node_num), queued(node_num, false) {}
+
+    size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+    bool contains(int id) const { return queued[id]; }
+    int top_id() const { return heap.top().node; }
+
+    void push(int id, double dist) {
+        assert(!queued[id]);
+        handles[id] = heap.push(NODE_M(id, dist));
+        queued[id] = true;
+    }
+
+    void pop() {
+        queued[heap.top().node] = false;
+        heap.pop();
+    }
+
+    void decrease_key(int id, double dist) {
+        assert(queued[id]);
+        if constexpr (has_decrease_key<Heap>::value)
+            heap.decrease_key(handles[id], NODE_M(id, dist));
+        else
+            //boost ranks by compare_item, so a smaller distance is a priority increase
+            heap.increase(handles[id], NODE_M(id, dist));
+    }
+};
+
+//one direction of an undirected edge, stored contiguously per source node
+struct Arc {
+    int to;
+    double d;
+};
+
+//zero-copy view over the arcs leaving one node
+struct arc_range {
+    const Arc * first;
+    const Arc * last;
+    const Arc * begin() const {return first;}
+    const Arc * end() const {return last;}
+    size_t size() const {return last - first;}
+    bool empty() const {return first == last;}
+};
+
+//compressed sparse row graph: the arcs of node u are arcs[offsets[u] .. offsets[u+1])
+//built once from an edge list; every undirected edge is stored in both directions.
+//The arrays are either owned or borrowed from external storage (e.g. a mapped
+//cache file) that `storage` keeps alive.
 class Graph{
 private:
-    std::map<int,std::list<int>> adj_map;
-    std::map<std::pair<int,int>,double> dist_map;
+    std::vector<size_t> own_offsets;
+    std::vector<Arc> own_arcs;
+    std::shared_ptr<const void> storage;
+    const size_t * offsets = nullptr;
+    const Arc * arcs = nullptr;
+    size_t nodes = 0;
+    size_t arc_cnt = 0;
+
+    void adopt_owned() {
+        offsets = own_offsets.data();
+        arcs = own_arcs.data();
+        nodes = own_offsets.empty() ? 0 : own_offsets.size()-1;
+        arc_cnt = own_arcs.size();
+    }
+
 public:
     Graph(){}
 
-    bool has_edge(Edge e) const {
-        return dist_map.count(std::make_pair(e.u,e.v)) || dist_map.count(std::make_pair(e.v,e.u));
+    Graph(int node_num, const std::vector<Edge> &edges) : own_offsets(node_num+1,0), own_arcs(2*edges.size()) {
+        //count degrees, prefix-sum them into offsets, then scatter in edge order
+        //(keeps each node's neighbours in insertion order)
+        for (const auto &e : edges) {
+            assert(e.u>=0 && e.u<node_num && e.v>=0 && e.v<node_num);
+            own_offsets[e.u+1]++;
+            own_offsets[e.v+1]++;
+        }
+        for (int n=0; n<node_num; n++)
+            own_offsets[n+1] += own_offsets[n];
+        std::vector<size_t> pos(own_offsets.begin(), own_offsets.end()-1);
+        for (const auto &e : edges) {
+            own_arcs[pos[e.u]++] = Arc{e.v,e.d}; // u -> v direction
+            own_arcs[pos[e.v]++] = Arc{e.u,e.d}; // v -> u direction
+        }
+        adopt_owned();
     }
 
-    bool has_edge(int u, int v) const {
-        return dist_map.count(std::make_pair(u,v)) || dist_map.count(std::make_pair(v,u));
+    //adopt ready-made CSR arrays (offsets has node_num+1 entries)
+    Graph(std::vector<size_t> &&offsets, std::vector<Arc> &&arcs) : own_offsets(std::move(offsets)), own_arcs(std::move(arcs)) {
+        assert(!own_offsets.empty() && own_offsets.back() == own_arcs.size());
+        adopt_owned();
     }
 
-    void add_edge(Edge e){
-        assert(!has_edge(e)); // do not add repeated edge
-        adj_map[e.u].push_back(e.v); // u -> v direction
-        adj_map[e.v].push_back(e.u); // v -> u direction
-        dist_map[std::make_pair(e.u,e.v)] = e.d;
+    //borrow CSR arrays that live in `storage`
+    Graph(const size_t *offsets, const Arc *arcs, size_t node_num, std::shared_ptr<const void> storage)
+        : storage(std::move(storage)), offsets(offsets), arcs(arcs), nodes(node_num), arc_cnt(offsets[node_num]) {}
+
+    //moving keeps the vector buffers, so the views stay valid; copying would not
+    Graph(Graph &&) = default;
+    Graph & operator=(Graph &&) = default;
+    Graph(const Graph &) = delete;
+    Graph & operator=(const Graph &) = delete;
+
+    bool is_view() const {
+        return storage != nullptr;
     }
 
-    const std::list<int> get_list(int node) const{
-        return (adj_map.count(node)) ? adj_map.at(node) : std::list<int>(); 
+    const size_t * offsets_data() const {
+        return offsets;
     }
 
-    const double get_dist(int u, int v) const {
-        assert(has_edge(u,v));
-        if (dist_map.count(std::make_pair(u,v))) {
-            return dist_map.at(std::make_pair(u,v));
-        } else {
-            return dist_map.at(std::make_pair(v,u));
-        }
+    const Arc * arcs_data() const {
+        return arcs;
+    }
+
+    size_t node_num() const {
+        return nodes;
+    }
+
+    size_t edge_num() const {
+        return arc_cnt/2;
+    }
+
+    arc_range neighbors(int node) const {
+        return arc_range{arcs+offsets[node], arcs+offsets[node+1]};
+    }
+
+    bool has_edge(int u, int v) const {
+        for (const auto &a : neighbors(u))
+            if (a.to == v) return true;
+        return false;
+    }
+
+    bool has_edge(Edge e) const {
+        return has_edge(e.u,e.v);
+    }
+
+    double get_dist(int u, int v) const {
+        for (const auto &a : neighbors(u))
+            if (a.to == v) return a.d;
+        assert(false && "no such edge");
+        return DBL_MAX;
     }
 
 };
@@ -0,0 +1,186 @@
+#ifndef GRAPH_CACHE_H
+#define GRAPH_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "graph.h"
+
+// on-disk cache of generated CSR graphs, so repeated TEST II runs map the
+// graph instead of regenerating it.
+//
+// File layout (native endianness, every section 64-byte aligned):
+//   file_header | offsets: uint64[node_num + 1] | arcs: Arc[arc_num]
+//
+// A file is only used when magic, format version, the Arc layout and the
+// generation key (seed, node count, edge draws, generator version) all
+// match; anything else counts as a miss and is regenerated. On Linux the
+// file is mapped read-only and the graph points straight into it; Windows
+// reads it into owned arrays.
+namespace graph_cache {
+
+constexpr uint32_t format_version = 1;
+constexpr uint64_t section_align = 64;
+
+struct key {
+    uint64_t seed;
+    uint64_t node_num;
+    uint64_t edge_draws;
+    uint64_t gen_version; // bump when the generator's output changes
+};
+
+struct file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t arc_bytes;
+    key k;
+    uint64_t arc_num;
+    uint64_t offsets_at;
+    uint64_t arcs_at;
+    uint64_t file_bytes;
+};
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "the cached offsets are stored as size_t");
+
+inline constexpr char magic[8] = {'N', 'H', 'P', 'Q', 'G', 'R', 'P', 'H'};
+
+inline uint64_t align_up(uint64_t n) {
+    return (n + section_align - 1) / section_align * section_align;
+}
+
+inline file_header make_header(const key & k, uint64_t arc_num) {
+    file_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = format_version;
+    h.arc_bytes = sizeof(Arc);
+    h.k = k;
+    h.arc_num = arc_num;
+    h.offsets_at = align_up(sizeof(file_header));
+    h.arcs_at = align_up(h.offsets_at + (k.node_num + 1) * sizeof(uint64_t));
+    h.file_bytes = h.arcs_at + arc_num * sizeof(Arc);
+    return h;
+}
+
+inline bool header_matches(const file_header & h, const key & k, uint64_t file_bytes) {
+    if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != format_version || h.arc_bytes != sizeof(Arc))
+        return false;
+    if (std::memcmp(&h.k, &k, sizeof(key)) != 0)
+        return false;
+    const file_header want = make_header(k, h.arc_num);
+    return h.offsets_at == want.offsets_at && h.arcs_at == want.arcs_at &&
+           h.file_bytes == want.file_bytes && h.file_bytes == file_bytes;
+}
+
+// cache file of one generation key inside `dir`
+inline std::string path_for(const std::string & dir, const key & k) {
+    char name[128];
+    std::snprintf(name, sizeof(name), "graph_s%llu_n%llu_e%llu_g%llu.v%u.bin",
+                  (unsigned long long)k.seed, (unsigned long long)k.node_num,
+                  (unsigned long long)k.edge_draws, (unsigned long long)k.gen_version, format_version);
+    return (std::filesystem::path(dir) / name).string();
+}
+
+// write `g` to `path`; written to a temporary name first and renamed, so a
+// concurrent or interrupted run never leaves a half-written cache file
+inline bool save(const std::string & path, const key & k, const Graph & g) {
+    std::error_code ec;
+    const std::filesystem::path target(path);
+    if (target.has_parent_path())
+        std::filesystem::create_directories(target.parent_path(), ec);
+
+    const uint64_t arc_num = g.node_num() ? g.offsets_data()[g.node_num()] : 0;
+    const file_header h = make_header(k, arc_num);
+    const std::string tmp = path + ".tmp";
+    FILE * f = std::fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+
+    static const char zeros[section_align] = {};
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && std::fwrite(zeros, 1, h.offsets_at - sizeof(h), f) == h.offsets_at - sizeof(h);
+    ok = ok && std::fwrite(g.offsets_data(), sizeof(uint64_t), k.node_num + 1, f) == k.node_num + 1;
+    const uint64_t pad = h.arcs_at - (h.offsets_at + (k.node_num + 1) * sizeof(uint64_t));
+    ok = ok && std::fwrite(zeros, 1, pad, f) == pad;
+    ok = ok && std::fwrite(g.arcs_data(), sizeof(Arc), arc_num, f) == arc_num;
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok)
+        std::filesystem::rename(tmp, target, ec);
+    if (!ok || ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+// the cached graph for `k`, or an empty graph (node_num() == 0) on a miss
+inline Graph load(const std::string & path, const key & k) {
+#if defined(_WIN32)
+    FILE * f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return Graph();
+    file_header h;
+    std::error_code ec;
+    const uint64_t bytes = std::filesystem::file_size(path, ec);
+    if (ec || std::fread(&h, sizeof(h), 1, f) != 1 || !header_matches(h, k, bytes)) {
+        std::fclose(f);
+        return Graph();
+    }
+    std::vector<size_t> offsets(k.node_num + 1);
+    std::vector<Arc> arcs(h.arc_num);
+    bool ok = _fseeki64(f, static_cast<long long>(h.offsets_at), SEEK_SET) == 0 &&
+              std::fread(offsets.data(), sizeof(uint64_t), offsets.size(), f) == offsets.size();
+    ok = ok && _fseeki64(f, static_cast<long long>(h.arcs_at), SEEK_SET) == 0 &&
+         std::fread(arcs.data(), sizeof(Arc), arcs.size(), f) == arcs.size();
+    std::fclose(f);
+    if (!ok || offsets.back() != h.arc_num)
+        return Graph();
+    return Graph(std::move(offsets), std::move(arcs));
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return Graph();
+    struct stat st;
+    file_header h;
+    if (::fstat(fd, &st) != 0 || ::pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+        !header_matches(h, k, static_cast<uint64_t>(st.st_size))) {
+        ::close(fd);
+        return Graph();
+    }
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    // fault the file in now, not during the timed search
+    flags |= MAP_POPULATE;
+#endif
+    void * p = ::mmap(nullptr, h.file_bytes, PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return Graph();
+
+    const uint64_t len = h.file_bytes;
+    std::shared_ptr<const void> storage(p, [len](const void * q) { ::munmap(const_cast<void *>(q), len); });
+    const char * base = static_cast<const char *>(p);
+    const size_t * offsets = reinterpret_cast<const size_t *>(base + h.offsets_at);
+    if (offsets[k.node_num] != h.arc_num)
+        return Graph();
+    return Graph(offsets, reinterpret_cast<const Arc *>(base + h.arcs_at), k.node_num, std::move(storage));
+#endif
+}
+
+} // namespace graph_cache
+
+#endif // GRAPH_CACHE_H
@@ -0,0 +1,115 @@
+#ifndef GRAPH_GEN_H
+#define GRAPH_GEN_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "graph.h"
+#include "parallel_util.h"
+
+// deterministic, multi-threaded random graph for TEST II.
+//
+// Every random number is a pure function of (seed, counter) (counter-based
+// RNG, no shared state), so edge k is the same no matter which thread draws
+// it. Duplicates are removed by a parallel sort on (pair, k) plus a stable
+// compaction that keeps the first occurrence, and the CSR arrays are filled
+// by a parallel counting scatter followed by a per-node sort. The resulting graph is
+// byte-identical for any thread count.
+namespace graph_gen {
+
+// value `counter` of random stream `seed` (splitmix64 finalizer over a Weyl step)
+inline uint64_t rng_at(uint64_t seed, uint64_t counter) {
+    uint64_t z = seed * 0x9E3779B97F4A7C15ull + (counter + 1) * 0xD1B54A32D192ED03ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// map a random 64-bit value onto [0, n)
+inline uint32_t uniform(uint64_t r, uint32_t n) {
+    return static_cast<uint32_t>((static_cast<unsigned __int128>(r) * n) >> 64);
+}
+
+// bump whenever the generated graph for a given seed changes (keys the graph cache)
+constexpr uint64_t version = 1;
+
+// counters used per candidate edge: u, v, weight
+constexpr uint64_t draws_per_edge = 3;
+
+struct gen_edge {
+    uint64_t key; // (min(u,v) << 32) | max(u,v), or no_edge for self loops
+    uint64_t idx; // draw order, breaks ties so the first occurrence wins
+    double d;
+};
+
+constexpr uint64_t no_edge = std::numeric_limits<uint64_t>::max();
+
+// edge_draws candidate edges over node_num nodes, weights are integers in
+// 1..10; self loops and repeated pairs are dropped (first draw wins) and the
+// survivors come back sorted by pair
+inline std::vector<gen_edge> generate_edges(uint32_t node_num, uint64_t edge_draws, uint64_t seed, unsigned threads) {
+    std::vector<gen_edge> cand(edge_draws);
+    par::parallel_for(threads, edge_draws, [&](unsigned, size_t b, size_t e) {
+        for (size_t k = b; k < e; k++) {
+            const uint64_t c = k * draws_per_edge;
+            const uint32_t u = uniform(rng_at(seed, c), node_num);
+            const uint32_t v = uniform(rng_at(seed, c + 1), node_num);
+            const double d = 1.0 + static_cast<double>(rng_at(seed, c + 2) % 10);
+            const uint64_t key = (u == v) ? no_edge :
+                (static_cast<uint64_t>(std::min(u, v)) << 32) | std::max(u, v);
+            cand[k] = gen_edge{key, k, d};
+        }
+    });
+
+    par::parallel_sort(cand, threads, [](const gen_edge & a, const gen_edge & b) {
+        return a.key != b.key ? a.key < b.key : a.idx < b.idx;
+    });
+    par::parallel_compact(cand, threads, [&](size_t i) {
+        return cand[i].key != no_edge && (i == 0 || cand[i - 1].key != cand[i].key);
+    });
+    return cand;
+}
+
+// undirected CSR graph: both directions of every edge, neighbours sorted by
+// id. Arcs are scattered with atomic per-node cursors (any order), and the
+// per-node sort makes the result independent of that order.
+inline Graph build_csr(uint32_t node_num, const std::vector<gen_edge> & edges, unsigned threads) {
+    std::vector<std::atomic<uint32_t>> cursor(node_num);
+    par::parallel_for(threads, edges.size(), [&](unsigned, size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            cursor[edges[i].key >> 32].fetch_add(1, std::memory_order_relaxed);
+            cursor[edges[i].key & 0xFFFFFFFFull].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    std::vector<size_t> offsets(static_cast<size_t>(node_num) + 1);
+    for (uint32_t n = 0; n < node_num; n++) {
+        offsets[n + 1] = offsets[n] + cursor[n].load(std::memory_order_relaxed);
+        cursor[n].store(0, std::memory_order_relaxed);
+    }
+
+    std::vector<Arc> arcs(offsets.back());
+    par::parallel_for(threads, edges.size(), [&](unsigned, size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) {
+            const uint32_t u = edges[i].key >> 32, v = edges[i].key & 0xFFFFFFFFull;
+            arcs[offsets[u] + cursor[u].fetch_add(1, std::memory_order_relaxed)] = Arc{static_cast<int>(v), edges[i].d};
+            arcs[offsets[v] + cursor[v].fetch_add(1, std::memory_order_relaxed)] = Arc{static_cast<int>(u), edges[i].d};
+        }
+    });
+    std::vector<std::atomic<uint32_t>>().swap(cursor);
+
+    par::parallel_for(threads, node_num, [&](unsigned, size_t b, size_t e) {
+        for (size_t n = b; n < e; n++)
+            std::sort(arcs.begin() + offsets[n], arcs.begin() + offsets[n + 1],
+                      [](const Arc & x, const Arc & y) { return x.to < y.to; });
+    });
+
+    return Graph(std::move(offsets), std::move(arcs));
+}
+
+} // namespace graph_gen
+
+#endif // GRAPH_GEN_H
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// order-preserving key encodings: the sift loops compare encoded keys only,
+// so every supported key type maps onto a plain integer with the same order.
+template <class Key>
+struct heap_key_traits;
+
+template <>
+struct heap_key_traits<int>
+{
+    using encoded_type = int;
+    static inline encoded_type encode(int k) noexcept { return k; }
+    static inline int decode(encoded_type e) noexcept { return e; }
+};
+
+template <>
+struct heap_key_traits<std::uint32_t>
+{
+    using encoded_type = std::uint32_t;
+    static inline encoded_type encode(std::uint32_t k) noexcept { return k; }
+    static inline std::uint32_t decode(encoded_type e) noexcept { return e; }
+};
+
+template <>
+struct heap_key_traits<std::uint64_t>
+{
+    using encoded_type = std::uint64_t;
+    static inline encoded_type encode(std::uint64_t k) noexcept { return k; }
+    static inline std::uint64_t decode(encoded_type e) noexcept { return e; }
+};
+
+template <>
+struct heap_key_traits<double>
+{
+    // IEEE-754 doubles sort like sign-magnitude integers: flip all bits of
+    // negatives and only the sign bit of non-negatives to get unsigned order.
+    using encoded_type = std::uint64_t;
+    static constexpr std::uint64_t sign_bit = 1ull << 63;
+
+    static inline encoded_type encode(double k) noexcept
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &k, sizeof(bits));
+        return (bits & sign_bit) ? ~bits : (bits | sign_bit);
+    }
+
+    static inline double decode(encoded_type e) noexcept
+    {
+        const std::uint64_t bits = (e & sign_bit) ? (e & ~sign_bit) : ~e;
+        double k;
+        std::memcpy(&k, &bits, sizeof(k));
+        return k;
+    }
+};
+
+// unsigned view of an encoded key with the same order (radix-style queues
+// bucket on the bit pattern, so signed encodings get their sign bit flipped)
+template <class Key>
+struct radix_key_traits
+{
+    using encoded_type = typename heap_key_traits<Key>::encoded_type;
+    using radix_type = std::make_unsigned_t<encoded_type>;
+    static constexpr radix_type flip =
+        std::is_signed_v<encoded_type> ? radix_type(radix_type(1) << (sizeof(radix_type) * 8 - 1)) : radix_type(0);
+
+    static inline radix_type encode(Key k) noexcept { return static_cast<radix_type>(heap_key_traits<Key>::encode(k)) ^ flip; }
+    static inline Key decode(radix_type r) noexcept { return heap_key_traits<Key>::decode(static_cast<encoded_type>(r ^ flip)); }
+};
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// backing store for the implicit heaps.
+//
+// fixed:    one aligned operator new[] of the final size (the original path).
+// reserved: reserve a large virtual range up front and commit pages as the
+//           array grows, so growth never reallocates or copies.
+//
+// Reserved ranges can ask for 2MB pages to cut TLB misses on huge heaps:
+// `transparent` madvise()s the range for THP, `explicit_2m` maps each
+// committed extent from the hugetlbfs pool (and falls back to `transparent`
+// once the pool runs dry).
+// Windows has no incrementally committed large pages, so both degrade to
+// small pages there.
+
+enum class heap_pages
+{
+    small,
+    transparent,
+    explicit_2m,
+};
+
+inline const char* heap_pages_name(heap_pages p)
+{
+    switch (p) {
+    case heap_pages::small: return "small";
+    case heap_pages::transparent: return "thp";
+    case heap_pages::explicit_2m: return "hugetlb";
+    }
+    return "?";
+}
+
+struct heap_growable_t
+{
+    explicit heap_growable_t() = default;
+};
+inline constexpr heap_growable_t heap_growable{};
+
+class heap_region
+{
+public:
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t huge_page = std::size_t(2) << 20;
+
+    heap_region() = default;
+
+    // fixed-size aligned block
+    explicit heap_region(std::size_t bytes) :
+        base(static_cast<char*>(::operator new[](bytes ? bytes : alignment, std::align_val_t(alignment)))),
+        reserved(bytes), committed(bytes), fixed(true)
+    {
+    }
+
+    // reserved address range, nothing committed yet
+    heap_region(heap_growable_t, std::size_t bytes, heap_pages pages) : pages(pages)
+    {
+        granule = (pages == heap_pages::small) ? page_size() : huge_page;
+        reserved = round_up(bytes ? bytes : granule, granule);
+        base = reserve(reserved);
+    }
+
+    heap_region(heap_region&& o) noexcept { swap(o); }
+    heap_region& operator=(heap_region&& o) noexcept
+    {
+        heap_region tmp(std::move(o));
+        swap(tmp);
+        return *this;
+    }
+    heap_region(const heap_region&) = delete;
+    heap_region& operator=(const heap_region&) = delete;
+
+    ~heap_region() { release(); }
+
+    char* data() const noexcept { return base; }
+    std::size_t reservedBytes() const noexcept { return reserved; }
+    std::size_t committedBytes() const noexcept { return committed; }
+    bool isFixed() const noexcept { return fixed; }
+    heap_pages pageKind() const noexcept { return pages; }
+
+    // make at least `bytes` of the range usable; false once the reservation is exhausted
+    bool commit(std::size_t bytes)
+    {
+        if (bytes <= committed)
+            return true;
+        if (fixed || bytes > reserved)
+            return false;
+
+        const std::size_t target = round_up(bytes, granule);
+        const std::size_t upto = target < reserved ? target : reserved;
+#if defined(_WIN32)
+        if (!::VirtualAlloc(base + committed, upto - committed, MEM_COMMIT, PAGE_READWRITE))
+            throw std::bad_alloc();
+#else
+#ifdef MAP_HUGETLB
+        if (pages == heap_pages::explicit_2m) {
+            // map the new extent from the hugetlbfs pool over the reservation;
+            // the pool is checked here, so an empty pool fails now instead of
+            // raising SIGBUS on first touch.
+            void* p = ::mmap(base + committed, upto - committed, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                committed = upto;
+                return true;
+            }
+            // a failed MAP_FIXED may already have dropped the old extent:
+            // remap it from scratch rather than mprotect()ing it.
+            pages = heap_pages::transparent;
+            p = ::mmap(base + committed, reserved - committed, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+            if (p == MAP_FAILED)
+                throw std::bad_alloc();
+            ::madvise(base + committed, reserved - committed, MADV_HUGEPAGE);
+        }
+#endif
+        if (::mprotect(base + committed, upto - committed, PROT_READ | PROT_WRITE) != 0)
+            throw std::bad_alloc();
+#endif
+        committed = upto;
+        return true;
+    }
+
+private:
+    char* base = nullptr;
+    std::size_t reserved = 0;
+    std::size_t committed = 0;
+    std::size_t granule = 0;
+    bool fixed = false;
+    heap_pages pages = heap_pages::small;
+
+    void swap(heap_region& o) noexcept
+    {
+        std::swap(base, o.base);
+        std::swap(reserved, o.reserved);
+        std::swap(committed, o.committed);
+        std::swap(granule, o.granule);
+        std::swap(fixed, o.fixed);
+        std::swap(pages, o.pages);
+    }
+
+    static std::size_t round_up(std::size_t n, std::size_t g) { return (n + g - 1) / g * g; }
+
+    static std::size_t page_size()
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO si;
+        ::GetSystemInfo(&si);
+        return si.dwPageSize;
+#else
+        return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    char* reserve(std::size_t bytes)
+    {
+#if defined(_WIN32)
+        void* p = ::VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+        if (!p)
+            throw std::bad_alloc();
+        return static_cast<char*>(p);
+#else
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#ifndef MAP_HUGETLB
+        if (pages == heap_pages::explicit_2m)
+            pages = heap_pages::transparent;
+#endif
+        // over-reserve by one huge page so the usable range starts 2MB aligned;
+        // otherwise THP cannot back the first and last partial 2MB extents.
+        const std::size_t span = bytes + huge_page;
+        void* p = ::mmap(nullptr, span, PROT_NONE, flags, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        char* raw = static_cast<char*>(p);
+        char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<std::uintptr_t>(raw), huge_page));
+        if (aligned != raw)
+            ::munmap(raw, aligned - raw);
+        if (aligned + bytes != raw + span)
+            ::munmap(aligned + bytes, (raw + span) - (aligned + bytes));
+#ifdef MADV_HUGEPAGE
+        if (pages == heap_pages::transparent)
+            ::madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+        return aligned;
+#endif
+    }
+
+    void release() noexcept
+    {
+        if (!base)
+            return;
+        if (fixed) {
+            ::operator delete[](base, std::align_val_t(alignment));
+        } else {
+#if defined(_WIN32)
+            ::VirtualFree(base, 0, MEM_RELEASE);
+#else
+            ::munmap(base, reserved);
+#endif
+        }
+        base = nullptr;
+    }
+};
+
+// typed view over a heap_region that keeps [0, capacity()) constructed
+template <class T>
+class heap_array
+{
+public:
+    heap_array() = default;
+
+    explicit heap_array(std::size_t n) : region(sizeof(T) * n) { construct_upto(n); }
+
+    heap_array(heap_growable_t, std::size_t maxElems, heap_pages pages) :
+        region(heap_growable, sizeof(T) * maxElems, pages), limit(maxElems)
+    {
+    }
+
+    heap_array(heap_array&& o) noexcept :
+        region(std::move(o.region)), limit(std::exchange(o.limit, 0)), constructed(std::exchange(o.constructed, 0))
+    {
+    }
+    heap_array& operator=(heap_array&& o) noexcept
+    {
+        heap_array tmp(std::move(o));
+        std::swap(region, tmp.region);
+        std::swap(limit, tmp.limit);
+        std::swap(constructed, tmp.constructed);
+        return *this;
+    }
+
+    ~heap_array()
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            std::destroy_n(get(), constructed);
+    }
+
+    T* get() const noexcept { return reinterpret_cast<T*>(region.data()); }
+    T& operator[](std::size_t i) const noexcept { return get()[i]; }
+
+    std::size_t capacity() const noexcept { return constructed; }
+    const heap_region& memory() const noexcept { return region; }
+
+    // grow the usable prefix to at least n elements (no reallocation)
+    bool grow(std::size_t n)
+    {
+        if (n <= constructed)
+            return true;
+        if (n > limit || !region.commit(sizeof(T) * n))
+            return false;
+        // everything committed is usable; round n up to it
+        construct_upto(std::min(limit, region.committedBytes() / sizeof(T)));
+        return true;
+    }
+
+private:
+    heap_region region;
+    std::size_t limit = 0;
+    std::size_t constructed = 0;
+
+    void construct_upto(std::size_t n)
+    {
+        if (limit < n)
+            limit = n;
+        std::uninitialized_default_construct_n(get() + constructed, n - constructed);
+        constructed = n;
+    }
+};
+
+// kB of the mapping containing `p` that is currently backed by huge pages
+// (AnonHugePages + hugetlb); -1 where /proc/self/smaps is unavailable.
+inline long resident_huge_kb(const void* p)
+{
+#if defined(__linux__)
+    FILE* f = std::fopen("/proc/self/smaps", "r");
+    if (!f)
+        return -1;
+    const auto addr = reinterpret_cast<std::uintptr_t>(p);
+    char line[512];
+    bool inside = false;
+    long kb = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        unsigned long lo, hi;
+        if (std::sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {
+            if (inside)
+                break;
+            inside = (addr >= lo && addr < hi);
+            continue;
+        }
+        long v;
+        if (inside && (std::sscanf(line, "AnonHugePages: %ld kB", &v) == 1 ||
+                       std::sscanf(line, "Private_Hugetlb: %ld kB", &v) == 1))
+            kb += v;
+    }
+    std::fclose(f);
+    return kb;
+#else
+    (void)p;
+    return -1;
+#endif
+}
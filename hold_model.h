@@ -0,0 +1,119 @@
+#ifndef HOLD_MODEL_H
+#define HOLD_MODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+// TEST III: the hold model (Vaucher & Duval 1975, Jones 1986), the steady
+// state of a discrete event scheduler. The queue is filled with N keys and
+// then kept at exactly N: every hold pops the minimum and pushes it back
+// advanced by a random increment, like the next event of the process that
+// just ran.
+//
+// How a queue behaves depends on where the new keys land relative to the
+// ones already queued, so the increment distribution is a parameter (all
+// have mean 1, in units of `scale`):
+//
+//   exp         exponential
+//   uniform     uniform on [0, 2)
+//   bimodal     90% uniform on [0, 0.2), 10% uniform on [0, 18.2)
+//   triangular  sum of two uniforms on [0, 1), peak at 1
+//   sawtooth    no randomness: a ramp from 0 to 2 repeated every
+//               `sawtooth_period` increments
+//
+// and so is the order of the initial fill (keys drawn from the same
+// distribution): random (as drawn), sorted (ascending) or reverse
+// (descending). Keys are int. The simulated time advances by about
+// `scale` / N per hold, so after holds_per_element * N holds the largest key
+// stays far below INT_MAX for any N.
+namespace hold_model {
+
+enum class dist { exp, uniform, bimodal, triangular, sawtooth };
+enum class fill { random, sorted, reverse };
+
+inline const char * const dist_names[] = {"exp", "uniform", "bimodal", "triangular", "sawtooth"};
+inline const char * const fill_names[] = {"random", "sorted", "reverse"};
+
+constexpr double scale = 1 << 20;
+constexpr size_t holds_per_element = 2;
+constexpr unsigned sawtooth_period = 1000;
+
+template <typename E, size_t K>
+bool parse(const std::string & name, const char * const (&names)[K], E & out) {
+    for (size_t k = 0; k < K; k++)
+        if (name == names[k]) {
+            out = static_cast<E>(k);
+            return true;
+        }
+    return false;
+}
+
+inline bool parse(const std::string & name, dist & out) { return parse(name, dist_names, out); }
+inline bool parse(const std::string & name, fill & out) { return parse(name, fill_names, out); }
+
+// increment generator; uniforms are built from the raw 64-bit draws, so the
+// stream is the same with every standard library
+class increments {
+    std::mt19937_64 rng;
+    dist d;
+    uint64_t n = 0;
+
+    double u01() { return static_cast<double>(rng() >> 11) * 0x1.0p-53; }
+
+    double unit() {
+        switch (d) {
+        case dist::exp:
+            return -std::log1p(-u01());
+        case dist::uniform:
+            return 2.0 * u01();
+        case dist::bimodal:
+            return u01() < 0.9 ? 0.2 * u01() : 18.2 * u01();
+        case dist::triangular:
+            return u01() + u01();
+        default:
+            return (static_cast<double>(n % sawtooth_period) + 0.5) * (2.0 / sawtooth_period);
+        }
+    }
+
+public:
+    increments(dist d, uint64_t seed) : rng(seed ^ 0x6A09E667F3BCC909ull), d(d) {}
+
+    int next() {
+        const int x = static_cast<int>(unit() * scale + 0.5);
+        n++;
+        return x;
+    }
+};
+
+// inputs of one cell, generated before the queue exists: the fill keys in
+// insertion order and one increment per hold
+struct workload {
+    std::vector<int> fill_keys;
+    std::vector<int> hold_increments;
+};
+
+inline workload make(size_t N, size_t holds, dist d, fill f, uint64_t seed) {
+    workload w;
+    increments inc(d, seed);
+    w.fill_keys.resize(N);
+    for (auto & k : w.fill_keys)
+        k = inc.next();
+    if (f == fill::sorted)
+        std::sort(w.fill_keys.begin(), w.fill_keys.end());
+    else if (f == fill::reverse)
+        std::sort(w.fill_keys.begin(), w.fill_keys.end(), std::greater<int>());
+    w.hold_increments.resize(holds);
+    for (auto & x : w.hold_increments)
+        x = inc.next();
+    return w;
+}
+
+} // namespace hold_model
+
+#endif // HOLD_MODEL_H
@@ -0,0 +1,147 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// per-operation latencies: a serialized cycle counter around single queue
+// operations, recorded into fixed-size log-linear histograms.
+//
+// The histogram follows HdrHistogram: values below 2^sub_bits get one bucket
+// each, above that every power of two is split into 2^sub_bits linear
+// buckets, so any value is kept to within 1/2^sub_bits (~3%) of its true
+// size over the whole 64-bit range. The counters live in a std::array, so
+// record() is a clz, a shift and an increment, and never allocates.
+namespace latency {
+
+// counter at the start of a timed op: earlier instructions have retired
+inline uint64_t start() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// counter at the end of a timed op: the op has retired, later ones wait
+inline uint64_t stop() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned aux;
+    const uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+#else
+    return start();
+#endif
+}
+
+// counter ticks per nanosecond, measured once against steady_clock
+inline double ticks_per_ns() {
+    static const double ratio = [] {
+#if defined(__x86_64__) || defined(__i386__)
+        const auto c0 = std::chrono::steady_clock::now();
+        const uint64_t t0 = start();
+        while (std::chrono::steady_clock::now() - c0 < std::chrono::milliseconds(20)) {
+        }
+        const uint64_t t1 = stop();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - c0).count();
+        return static_cast<double>(t1 - t0) / static_cast<double>(ns);
+#else
+        return 1.0;
+#endif
+    }();
+    return ratio;
+}
+
+// smallest start()/stop() difference of an empty region, in ticks
+inline uint64_t overhead_ticks() {
+    static const uint64_t ticks = [] {
+        uint64_t best = ~uint64_t(0);
+        for (int k = 0; k < 1000; k++) {
+            const uint64_t t0 = start();
+            best = std::min(best, stop() - t0);
+        }
+        return best;
+    }();
+    return ticks;
+}
+
+class histogram {
+public:
+    static constexpr unsigned sub_bits = 5;
+    static constexpr uint64_t sub_count = uint64_t(1) << sub_bits;
+    static constexpr size_t bucket_count = (64 - sub_bits + 1) * sub_count;
+
+private:
+    std::array<uint64_t, bucket_count> counts{};
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+    double sum = 0.0;
+
+    static size_t index(uint64_t v) {
+        if (v < sub_count)
+            return static_cast<size_t>(v);
+        const unsigned e = 63 - static_cast<unsigned>(__builtin_clzll(v));
+        const unsigned block = e - sub_bits + 1;
+        return block * sub_count + static_cast<size_t>((v >> (e - sub_bits)) - sub_count);
+    }
+
+    // largest value that falls into bucket `i`
+    static uint64_t highest_equivalent(size_t i) {
+        if (i < sub_count)
+            return i;
+        const unsigned block = static_cast<unsigned>(i / sub_count);
+        const uint64_t mantissa = sub_count + i % sub_count;
+        const unsigned shift = block - 1;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+public:
+    void record(uint64_t v) {
+        counts[index(v)]++;
+        total++;
+        max_value = std::max(max_value, v);
+        sum += static_cast<double>(v);
+    }
+
+    void merge(const histogram & other) {
+        for (size_t i = 0; i < bucket_count; i++)
+            counts[i] += other.counts[i];
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+        sum += other.sum;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return total ? sum / total : 0.0; }
+
+    // value at quantile q in [0, 1]: no more than a fraction q of the
+    // records lie above it (to within the bucket precision)
+    uint64_t quantile(double q) const {
+        if (total == 0)
+            return 0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucket_count; i++) {
+            seen += counts[i];
+            if (seen >= rank)
+                return std::min(highest_equivalent(i), max_value);
+        }
+        return max_value;
+    }
+};
+
+} // namespace latency
+
+#endif // LATENCY_HISTOGRAM_H
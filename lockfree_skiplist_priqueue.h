@@ -0,0 +1,442 @@
+#ifndef LOCKFREE_SKIPLIST_PRIQUEUE
+#define LOCKFREE_SKIPLIST_PRIQUEUE
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// deleted nodes at the front of the list before a pop tries to cut them off
+#ifndef LFSKIP_BOUND_OFFSET
+#define LFSKIP_BOUND_OFFSET 32
+#endif
+
+// epoch based reclamation: threads pin the global epoch for the length of
+// one operation, and the epoch only advances once every pinned thread has
+// seen it. A node unlinked by an operation pinned at e can still be reached
+// by operations pinned at e or e + 1, so it is freed once the epoch has
+// reached e + 3.
+class epoch_domain {
+
+public:
+    static constexpr unsigned max_threads = 256;
+    static constexpr uint64_t idle = 0;
+
+private:
+    struct alignas(64) record {
+        std::atomic<uint64_t> epoch{idle};
+        std::atomic<bool> used{false};
+    };
+
+    std::atomic<uint64_t> global{1};
+    record records[max_threads];
+
+public:
+    unsigned acquire_slot() {
+        for (;;)
+            for (unsigned s = 0; s < max_threads; s++)
+                if (!records[s].used.load(std::memory_order_relaxed) &&
+                    !records[s].used.exchange(true, std::memory_order_acquire))
+                    return s;
+    }
+
+    void release_slot(unsigned s) {
+        records[s].epoch.store(idle, std::memory_order_release);
+        records[s].used.store(false, std::memory_order_release);
+    }
+
+    // pin the current epoch. The fence orders the announcement before every
+    // later load of shared nodes (a seq_cst store alone still allows
+    // StoreLoad reordering); it pairs with the fence in try_advance
+    uint64_t enter(unsigned s) {
+        uint64_t e = global.load(std::memory_order_acquire);
+        records[s].epoch.store(e, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return e;
+    }
+
+    void leave(unsigned s) {
+        records[s].epoch.store(idle, std::memory_order_release);
+    }
+
+    uint64_t current() const {
+        return global.load(std::memory_order_acquire);
+    }
+
+    // move to e + 1 if every active thread has observed e; the fence makes
+    // the caller's unlinks visible before the scan reads the announcements
+    void try_advance(uint64_t e) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (const auto & r : records) {
+            const uint64_t v = r.epoch.load(std::memory_order_acquire);
+            if (v != idle && v != e)
+                return;
+        }
+        global.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+    }
+};
+
+// lock-free skiplist priority queue after Lindén & Jonsson, "A Skiplist-Based
+// Concurrent Priority Queue with Minimal Memory Contention" (OPODIS 2013).
+//
+// - a pop logically deletes the first live node by setting the low bit of
+//   its predecessor's level-0 pointer (one fetch_or), so deleted nodes always
+//   form a prefix of the list and pops only contend on that prefix;
+// - once the prefix is longer than LFSKIP_BOUND_OFFSET, the pop that sees it
+//   swings head past the whole prefix with a single CAS, repairs the upper
+//   levels of head and hands the cut nodes to the epoch reclaimer;
+// - inserts locate predecessors while skipping the deleted prefix, link
+//   level 0 with a CAS and then the upper levels one by one.
+//
+// The queue is strict (linearizable) and keeps duplicates. All access goes
+// through per-thread handles.
+template <typename T>
+class lockfree_skiplist_priqueue {
+
+public:
+    typedef T key_type;
+    static constexpr int max_levels = 32;
+    static constexpr size_t bound_offset = LFSKIP_BOUND_OFFSET;
+
+private:
+    struct node {
+        T key;
+        int height;
+        std::atomic<bool> inserting;
+        std::atomic<bool> taken;        // set by the pop that deleted it
+        std::atomic<uintptr_t> next[1]; // height entries, allocated inline
+    };
+
+    static node * unmarked(uintptr_t p) { return reinterpret_cast<node *>(p & ~uintptr_t(1)); }
+    static bool is_marked(uintptr_t p) { return (p & 1u) != 0; }
+    static uintptr_t ref(node * n) { return reinterpret_cast<uintptr_t>(n); }
+
+    static node * alloc_node(const T & key, int height) {
+        void * mem = ::operator new(sizeof(node) + (height - 1) * sizeof(std::atomic<uintptr_t>));
+        node * n = static_cast<node *>(mem);
+        new (&n->key) T(key);
+        n->height = height;
+        new (&n->inserting) std::atomic<bool>(true);
+        new (&n->taken) std::atomic<bool>(false);
+        for (int i = 0; i < height; i++)
+            new (&n->next[i]) std::atomic<uintptr_t>(0);
+        return n;
+    }
+
+    static void free_node(node * n) {
+        n->key.~T();
+        ::operator delete(n);
+    }
+
+    node * head;
+    node * tail;
+    epoch_domain epochs;
+    std::atomic<uint64_t> next_seed{0x9E3779B97F4A7C15ull};
+
+    // nodes retired by handles that went away before they could free them
+    std::mutex orphan_m;
+    std::vector<node *> orphans;
+
+    // predecessors/successors of `key` on every level, skipping the deleted
+    // prefix; returns the last deleted node seen on level 0. A key below the
+    // prefix goes right behind it on level 0, so upper levels skip every
+    // node already taken too; otherwise the prefix's last node (which stays
+    // until the next cut) would stop such keys from linking above level 0.
+    node * locate_preds(const T & key, node ** preds, node ** succs) {
+        node * x = head;
+        node * del = nullptr;
+        for (int i = max_levels - 1; i >= 0; i--) {
+            uintptr_t raw = x->next[i].load(std::memory_order_acquire);
+            bool d = is_marked(raw);
+            node * cur = unmarked(raw);
+            while (cur != tail && (cur->key < key || is_marked(cur->next[0].load(std::memory_order_acquire)) ||
+                                   (i == 0 && d) || (i > 0 && cur->taken.load(std::memory_order_acquire)))) {
+                if (d && i == 0)
+                    del = cur;
+                x = cur;
+                raw = x->next[i].load(std::memory_order_acquire);
+                d = is_marked(raw);
+                cur = unmarked(raw);
+            }
+            preds[i] = x;
+            succs[i] = cur;
+        }
+        return del;
+    }
+
+    // point head's upper levels past the nodes that were just cut
+    void restructure() {
+        node * pred = head;
+        for (int i = max_levels - 1; i > 0;) {
+            node * h = unmarked(head->next[i].load(std::memory_order_acquire));
+            if (h == tail || !is_marked(h->next[0].load(std::memory_order_acquire))) {
+                i--;
+                continue;
+            }
+            node * cur = unmarked(pred->next[i].load(std::memory_order_acquire));
+            while (cur != tail && is_marked(cur->next[0].load(std::memory_order_acquire))) {
+                pred = cur;
+                cur = unmarked(pred->next[i].load(std::memory_order_acquire));
+            }
+            uintptr_t expected = ref(h);
+            if (head->next[i].compare_exchange_strong(expected, ref(cur), std::memory_order_acq_rel))
+                i--;
+        }
+    }
+
+public:
+    class handle {
+        friend class lockfree_skiplist_priqueue;
+
+        lockfree_skiplist_priqueue * q;
+        unsigned slot;
+        uint64_t rng;
+        // retired nodes by pinned epoch % 3, with that epoch
+        std::vector<node *> limbo[3];
+        uint64_t limbo_epoch[3] = {0, 0, 0};
+        size_t retired = 0;
+
+        handle(lockfree_skiplist_priqueue * q, uint64_t seed) : q(q), slot(q->epochs.acquire_slot()), rng(seed) {}
+
+        // geometric height with p = 1/2 from one random word
+        int random_height() {
+            rng ^= rng >> 12;
+            rng ^= rng << 25;
+            rng ^= rng >> 27;
+            const uint64_t r = (rng * 0x2545F4914F6CDD1Dull) | (uint64_t(1) << (max_levels - 1));
+            return 1 + __builtin_ctzll(r);
+        }
+
+        uint64_t enter() {
+            const uint64_t e = q->epochs.enter(slot);
+            for (int k = 0; k < 3; k++)
+                if (!limbo[k].empty() && limbo_epoch[k] + 3 <= e) {
+                    for (node * n : limbo[k])
+                        free_node(n);
+                    retired -= limbo[k].size();
+                    limbo[k].clear();
+                }
+            return e;
+        }
+
+        void leave() {
+            q->epochs.leave(slot);
+        }
+
+        void retire(node * n, uint64_t e) {
+            std::vector<node *> & l = limbo[e % 3];
+            assert(l.empty() || limbo_epoch[e % 3] == e);
+            limbo_epoch[e % 3] = e;
+            l.push_back(n);
+            retired++;
+        }
+
+        void release() {
+            if (!q)
+                return;
+            std::lock_guard<std::mutex> lk(q->orphan_m);
+            for (auto & l : limbo) {
+                q->orphans.insert(q->orphans.end(), l.begin(), l.end());
+                l.clear();
+            }
+            q->epochs.release_slot(slot);
+            q = nullptr;
+        }
+
+    public:
+        handle(handle && o) noexcept : q(o.q), slot(o.slot), rng(o.rng), retired(o.retired) {
+            for (int k = 0; k < 3; k++) {
+                limbo[k].swap(o.limbo[k]);
+                limbo_epoch[k] = o.limbo_epoch[k];
+            }
+            o.q = nullptr;
+        }
+        handle & operator=(handle &&) = delete;
+        handle(const handle &) = delete;
+
+        ~handle() {
+            release();
+        }
+
+        void push(const T & key) {
+            node * preds[max_levels];
+            node * succs[max_levels];
+            const int height = random_height();
+            node * n = alloc_node(key, height);
+
+            enter();
+            node * del;
+            for (;;) {
+                del = q->locate_preds(key, preds, succs);
+                n->next[0].store(ref(succs[0]), std::memory_order_relaxed);
+                uintptr_t expected = ref(succs[0]);
+                if (preds[0]->next[0].compare_exchange_strong(expected, ref(n), std::memory_order_acq_rel))
+                    break;
+            }
+            for (int i = 1; i < height;) {
+                n->next[i].store(ref(succs[i]), std::memory_order_relaxed);
+                // stop linking once the new node, or its successor here, is deleted
+                if (is_marked(n->next[0].load(std::memory_order_acquire)) ||
+                    (succs[i] != q->tail && is_marked(succs[i]->next[0].load(std::memory_order_acquire))) ||
+                    succs[i] == del)
+                    break;
+                uintptr_t expected = ref(succs[i]);
+                if (preds[i]->next[i].compare_exchange_strong(expected, ref(n), std::memory_order_acq_rel)) {
+                    i++;
+                } else {
+                    del = q->locate_preds(key, preds, succs);
+                    if (succs[0] != n)
+                        break;
+                }
+            }
+            n->inserting.store(false, std::memory_order_release);
+            leave();
+        }
+
+        void flush() {}
+
+        // strict pop; false if the queue was empty
+        bool try_pop(T & out) {
+            const uint64_t e = enter();
+            node * x = q->head;
+            const uintptr_t obs_head = x->next[0].load(std::memory_order_acquire);
+            node * new_head = nullptr;
+            size_t offset = 0;
+            uintptr_t nxt;
+            do {
+                nxt = x->next[0].load(std::memory_order_acquire);
+                if (unmarked(nxt) == q->tail) {
+                    leave();
+                    return false;
+                }
+                if (new_head == nullptr && x->inserting.load(std::memory_order_acquire))
+                    new_head = x;
+                nxt = x->next[0].fetch_or(1, std::memory_order_acq_rel);
+                offset++;
+                x = unmarked(nxt);
+            } while (is_marked(nxt));
+            out = x->key;
+            x->taken.store(true, std::memory_order_release);
+
+            if (offset >= bound_offset) {
+                if (new_head == nullptr)
+                    new_head = x;
+                uintptr_t expected = obs_head;
+                if (q->head->next[0].compare_exchange_strong(expected, ref(new_head) | 1u, std::memory_order_acq_rel)) {
+                    q->restructure();
+                    for (node * cur = unmarked(obs_head); cur != new_head;) {
+                        node * next = unmarked(cur->next[0].load(std::memory_order_acquire));
+                        retire(cur, e);
+                        cur = next;
+                    }
+                    if (retired >= 2 * bound_offset)
+                        q->epochs.try_advance(q->epochs.current());
+                }
+            }
+            leave();
+            return true;
+        }
+    };
+
+    lockfree_skiplist_priqueue() {
+        head = alloc_node(T{}, max_levels);
+        tail = alloc_node(T{}, max_levels);
+        head->inserting.store(false, std::memory_order_relaxed);
+        tail->inserting.store(false, std::memory_order_relaxed);
+        // a pointer to tail is never marked, so pops stop at it
+        for (int i = 0; i < max_levels; i++)
+            head->next[i].store(ref(tail), std::memory_order_relaxed);
+    }
+
+    lockfree_skiplist_priqueue(const lockfree_skiplist_priqueue &) = delete;
+    lockfree_skiplist_priqueue & operator=(const lockfree_skiplist_priqueue &) = delete;
+
+    // all handles must be gone
+    ~lockfree_skiplist_priqueue() {
+        for (node * n : orphans)
+            free_node(n);
+        for (node * cur = unmarked(head->next[0].load(std::memory_order_relaxed)); cur != tail;) {
+            node * next = unmarked(cur->next[0].load(std::memory_order_relaxed));
+            free_node(cur);
+            cur = next;
+        }
+        free_node(head);
+        free_node(tail);
+    }
+
+    handle get_handle() {
+        return handle(this, next_seed.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed) | 1u);
+    }
+
+    // live elements; walks the list, so only meaningful when quiescent
+    size_t size() const {
+        size_t n = 0;
+        bool deleted = is_marked(head->next[0].load(std::memory_order_acquire));
+        for (node * cur = unmarked(head->next[0].load(std::memory_order_acquire)); cur != tail;) {
+            const uintptr_t raw = cur->next[0].load(std::memory_order_acquire);
+            if (!deleted)
+                n++;
+            deleted = is_marked(raw);
+            cur = unmarked(raw);
+        }
+        return n;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+};
+
+// sequential front end for the single-threaded workloads (one handle)
+template <typename T>
+class lockfree_skiplist_seq_priqueue {
+
+    typedef lockfree_skiplist_priqueue<T> queue_type;
+
+    queue_type q;
+    typename queue_type::handle h;
+    T head;
+    bool has_head = false;
+    size_t total_num = 0;
+
+public:
+    lockfree_skiplist_seq_priqueue() : h(q.get_handle()) {}
+
+    size_t size(void) const {
+        return total_num;
+    }
+
+    bool empty(void) const {
+        return total_num == 0;
+    }
+
+    void push(const T key) {
+        // keep the peeked element the minimum
+        if (has_head && key < head) {
+            h.push(head);
+            head = key;
+        } else {
+            h.push(key);
+        }
+        total_num++;
+    }
+
+    const T & top(void) {
+        assert(!empty());
+        if (!has_head)
+            has_head = h.try_pop(head);
+        return head;
+    }
+
+    void pop(void) {
+        top();
+        has_head = false;
+        total_num--;
+    }
+};
+
+#endif //LOCKFREE_SKIPLIST_PRIQUEUE
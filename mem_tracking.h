@@ -0,0 +1,195 @@
+#ifndef MEM_TRACKING_H
+#define MEM_TRACKING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// memory footprint of one benchmark cell:
+//
+// - heap: counters of every operator new/delete in the process (allocs,
+//   frees, live and peak bytes). They only count when the including
+//   translation unit defines MEM_TRACKING_DEFINE_OPERATORS, which replaces
+//   the global allocation functions; define it in exactly one translation
+//   unit (testmain.cc, with memtrack=1). Bytes are malloc_usable_size, i.e.
+//   what the allocator really hands out, on glibc; elsewhere only the
+//   counts are kept.
+// - resident set: VmRSS and VmHWM from /proc/self/status. The peak is reset
+//   at the start of a cell through /proc/self/clear_refs ("5", Linux 4.0+),
+//   so VmHWM is the peak of that cell rather than of the whole process.
+//
+// The counters are relaxed atomics, cheap next to the allocation itself but
+// not free, which is why counting is a build-time option.
+namespace mem_tracking {
+
+struct counters {
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> live_bytes{0};
+    std::atomic<uint64_t> peak_bytes{0};
+};
+
+inline counters heap;
+
+inline size_t usable_size(void * p) {
+#if defined(__GLIBC__)
+    return malloc_usable_size(p);
+#else
+    (void)p;
+    return 0;
+#endif
+}
+
+inline void note_alloc(void * p) {
+    const uint64_t n = usable_size(p);
+    heap.allocs.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t live = heap.live_bytes.fetch_add(n, std::memory_order_relaxed) + n;
+    uint64_t peak = heap.peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !heap.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+inline void note_free(void * p) {
+    heap.frees.fetch_add(1, std::memory_order_relaxed);
+    heap.live_bytes.fetch_sub(usable_size(p), std::memory_order_relaxed);
+}
+
+// resident set from /proc/self/status in kB; false where it is not available
+inline bool read_rss(uint64_t & rss_kb, uint64_t & hwm_kb) {
+    FILE * f = std::fopen("/proc/self/status", "r");
+    if (!f)
+        return false;
+    char line[256];
+    int found = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        unsigned long long kb;
+        if (std::sscanf(line, "VmRSS: %llu kB", &kb) == 1) {
+            rss_kb = kb;
+            found++;
+        } else if (std::sscanf(line, "VmHWM: %llu kB", &kb) == 1) {
+            hwm_kb = kb;
+            found++;
+        }
+    }
+    std::fclose(f);
+    return found == 2;
+}
+
+// reset VmHWM to the current VmRSS; false if the kernel does not allow it
+inline bool reset_peak_rss() {
+    FILE * f = std::fopen("/proc/self/clear_refs", "w");
+    if (!f)
+        return false;
+    const bool ok = std::fputs("5", f) >= 0;
+    return (std::fclose(f) == 0) && ok;
+}
+
+// state at the start of a cell; the heap peak restarts from the live bytes
+struct snapshot {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t live_bytes = 0;
+    uint64_t rss_kb = 0;
+    uint64_t hwm_kb = 0;
+    bool rss = false;
+    bool rss_peak_reset = false;
+};
+
+inline snapshot begin() {
+    snapshot s;
+    s.rss_peak_reset = reset_peak_rss();
+    s.rss = read_rss(s.rss_kb, s.hwm_kb);
+    s.allocs = heap.allocs.load(std::memory_order_relaxed);
+    s.frees = heap.frees.load(std::memory_order_relaxed);
+    s.live_bytes = heap.live_bytes.load(std::memory_order_relaxed);
+    heap.peak_bytes.store(s.live_bytes, std::memory_order_relaxed);
+    return s;
+}
+
+// heap usage since `s`
+struct usage {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t peak_bytes;     // peak live bytes above the start
+    int64_t retained_bytes;  // live bytes above the start, now
+};
+
+inline usage since(const snapshot & s) {
+    usage u;
+    u.allocs = heap.allocs.load(std::memory_order_relaxed) - s.allocs;
+    u.frees = heap.frees.load(std::memory_order_relaxed) - s.frees;
+    u.peak_bytes = heap.peak_bytes.load(std::memory_order_relaxed) - s.live_bytes;
+    u.retained_bytes = static_cast<int64_t>(heap.live_bytes.load(std::memory_order_relaxed)) -
+                       static_cast<int64_t>(s.live_bytes);
+    return u;
+}
+
+inline void * allocate(size_t size, size_t align) {
+    for (;;) {
+        void * p;
+        if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            p = std::malloc(size ? size : 1);
+        else
+            p = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+        if (p) {
+            note_alloc(p);
+            return p;
+        }
+        std::new_handler h = std::get_new_handler();
+        if (!h)
+            return nullptr;
+        h();
+    }
+}
+
+inline void deallocate(void * p) {
+    if (!p)
+        return;
+    note_free(p);
+    std::free(p);
+}
+
+} // namespace mem_tracking
+
+#if defined(MEM_TRACKING_DEFINE_OPERATORS)
+
+inline void * mem_tracking_new(size_t size, size_t align = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    if (void * p = mem_tracking::allocate(size, align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void * operator new(size_t n) { return mem_tracking_new(n); }
+void * operator new[](size_t n) { return mem_tracking_new(n); }
+void * operator new(size_t n, std::align_val_t a) { return mem_tracking_new(n, static_cast<size_t>(a)); }
+void * operator new[](size_t n, std::align_val_t a) { return mem_tracking_new(n, static_cast<size_t>(a)); }
+void * operator new(size_t n, const std::nothrow_t &) noexcept { return mem_tracking::allocate(n, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void * operator new[](size_t n, const std::nothrow_t &) noexcept { return mem_tracking::allocate(n, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void * operator new(size_t n, std::align_val_t a, const std::nothrow_t &) noexcept { return mem_tracking::allocate(n, static_cast<size_t>(a)); }
+void * operator new[](size_t n, std::align_val_t a, const std::nothrow_t &) noexcept { return mem_tracking::allocate(n, static_cast<size_t>(a)); }
+
+void operator delete(void * p) noexcept { mem_tracking::deallocate(p); }
+void operator delete[](void * p) noexcept { mem_tracking::deallocate(p); }
+void operator delete(void * p, size_t) noexcept { mem_tracking::deallocate(p); }
+void operator delete[](void * p, size_t) noexcept { mem_tracking::deallocate(p); }
+void operator delete(void * p, std::align_val_t) noexcept { mem_tracking::deallocate(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { mem_tracking::deallocate(p); }
+void operator delete(void * p, size_t, std::align_val_t) noexcept { mem_tracking::deallocate(p); }
+void operator delete[](void * p, size_t, std::align_val_t) noexcept { mem_tracking::deallocate(p); }
+void operator delete(void * p, const std::nothrow_t &) noexcept { mem_tracking::deallocate(p); }
+void operator delete[](void * p, const std::nothrow_t &) noexcept { mem_tracking::deallocate(p); }
+void operator delete(void * p, std::align_val_t, const std::nothrow_t &) noexcept { mem_tracking::deallocate(p); }
+void operator delete[](void * p, std::align_val_t, const std::nothrow_t &) noexcept { mem_tracking::deallocate(p); }
+
+#endif // MEM_TRACKING_DEFINE_OPERATORS
+
+#endif // MEM_TRACKING_H
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <cstdint>
+
+#include <immintrin.h>
+
+// vectorized "min and index of first min" over one children block of
+// MinHeapT. Blocks are arity keys wide, so with a 64-byte aligned heap a
+// block of 16 int32 or 8 uint64 keys is exactly one cache line.
+//
+// The instruction set is picked at compile time from the target flags
+// (e.g. ARCH_FLAGS=-march=native): AVX-512F, then AVX2, then SSE4.1.
+// Combinations without a kernel report `vectorized == false` and the heap
+// falls back to its unrolled scalar scan. Define NHPQ_MINHEAP_SIMD=0 to
+// force the scalar path.
+//
+// block_above is the admission test of TopKHeapT: a bit mask of the keys of
+// a block that exceed a threshold, one compare per lane.
+
+#ifndef NHPQ_MINHEAP_SIMD
+#define NHPQ_MINHEAP_SIMD 1
+#endif
+
+namespace minheap_simd
+{
+
+#if NHPQ_MINHEAP_SIMD && defined(__AVX512F__)
+inline constexpr const char* isa = "avx512";
+#elif NHPQ_MINHEAP_SIMD && defined(__AVX2__)
+inline constexpr const char* isa = "avx2";
+#elif NHPQ_MINHEAP_SIMD && defined(__SSE4_1__)
+inline constexpr const char* isa = "sse4.1";
+#else
+inline constexpr const char* isa = "scalar";
+#endif
+
+template <class T, std::uint32_t N>
+struct min_block
+{
+    static constexpr bool vectorized = false;
+};
+
+template <class T, std::uint32_t N>
+struct above_block
+{
+    static constexpr bool vectorized = false;
+};
+
+#if NHPQ_MINHEAP_SIMD && defined(__AVX512F__)
+
+// GCC 12's AVX-512 min/reduce intrinsics seed their results with a
+// self-initialized "undefined" vector and warn about it wherever they are
+// inlined; the values are fully written, so the warning is silenced here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+
+template <std::uint32_t N>
+struct min_block<int, N>
+{
+    static constexpr bool vectorized = (N % 16u == 0u);
+
+    // returns the offset of the first minimum of p[0..N-1], stores it in `out`
+    static inline __attribute__((always_inline)) std::uint32_t find(const int* p, int& out) noexcept
+    {
+        constexpr std::uint32_t lanes = N / 16u;
+        __m512i v[lanes];
+        v[0] = _mm512_loadu_si512(p);
+        __m512i m = v[0];
+        for (std::uint32_t k = 1u; k < lanes; ++k) {
+            v[k] = _mm512_loadu_si512(p + 16u * k);
+            m = _mm512_min_epi32(m, v[k]);
+        }
+        out = _mm512_reduce_min_epi32(m);
+        const __m512i b = _mm512_set1_epi32(out);
+        std::uint64_t mask = 0u;
+        for (std::uint32_t k = 0u; k < lanes; ++k)
+            mask |= static_cast<std::uint64_t>(_mm512_cmpeq_epi32_mask(v[k], b)) << (16u * k);
+        return static_cast<std::uint32_t>(__builtin_ctzll(mask));
+    }
+};
+
+template <std::uint32_t N>
+struct min_block<std::uint64_t, N>
+{
+    static constexpr bool vectorized = (N % 8u == 0u);
+
+    static inline __attribute__((always_inline)) std::uint32_t find(const std::uint64_t* p, std::uint64_t& out) noexcept
+    {
+        constexpr std::uint32_t lanes = N / 8u;
+        __m512i v[lanes];
+        v[0] = _mm512_loadu_si512(p);
+        __m512i m = v[0];
+        for (std::uint32_t k = 1u; k < lanes; ++k) {
+            v[k] = _mm512_loadu_si512(p + 8u * k);
+            m = _mm512_min_epu64(m, v[k]);
+        }
+        out = _mm512_reduce_min_epu64(m);
+        const __m512i b = _mm512_set1_epi64(static_cast<long long>(out));
+        std::uint64_t mask = 0u;
+        for (std::uint32_t k = 0u; k < lanes; ++k)
+            mask |= static_cast<std::uint64_t>(_mm512_cmpeq_epu64_mask(v[k], b)) << (8u * k);
+        return static_cast<std::uint32_t>(__builtin_ctzll(mask));
+    }
+};
+
+#pragma GCC diagnostic pop
+
+template <std::uint32_t N>
+struct above_block<int, N>
+{
+    static constexpr bool vectorized = (N % 16u == 0u);
+
+    // bit i set when p[i] > t
+    static inline __attribute__((always_inline)) std::uint64_t mask(const int* p, int t) noexcept
+    {
+        const __m512i b = _mm512_set1_epi32(t);
+        std::uint64_t m = 0u;
+        for (std::uint32_t k = 0u; k < N / 16u; ++k)
+            m |= static_cast<std::uint64_t>(_mm512_cmpgt_epi32_mask(_mm512_loadu_si512(p + 16u * k), b)) << (16u * k);
+        return m;
+    }
+};
+
+// 8 x int32 is half a zmm register; a ymm does it in fewer uops.
+template <>
+struct min_block<int, 8u>
+{
+    static constexpr bool vectorized = true;
+
+    static inline __attribute__((always_inline)) std::uint32_t find(const int* p, int& out) noexcept
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i m = _mm256_min_epi32(v, _mm256_permute2x128_si256(v, v, 1));
+        m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        out = _mm256_cvtsi256_si32(m);
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m))));
+        return static_cast<std::uint32_t>(__builtin_ctz(mask));
+    }
+};
+
+#elif NHPQ_MINHEAP_SIMD && defined(__AVX2__)
+
+template <std::uint32_t N>
+struct min_block<int, N>
+{
+    static constexpr bool vectorized = (N % 8u == 0u);
+
+    static inline __attribute__((always_inline)) std::uint32_t find(const int* p, int& out) noexcept
+    {
+        constexpr std::uint32_t lanes = N / 8u;
+        __m256i v[lanes];
+        v[0] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i m = v[0];
+        for (std::uint32_t k = 1u; k < lanes; ++k) {
+            v[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8u * k));
+            m = _mm256_min_epi32(m, v[k]);
+        }
+        // broadcast the horizontal minimum into every lane
+        m = _mm256_min_epi32(m, _mm256_permute2x128_si256(m, m, 1));
+        m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm256_min_epi32(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        out = _mm256_cvtsi256_si32(m);
+        std::uint64_t mask = 0u;
+        for (std::uint32_t k = 0u; k < lanes; ++k)
+            mask |= static_cast<std::uint64_t>(static_cast<unsigned>(
+                        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v[k], m)))))
+                    << (8u * k);
+        return static_cast<std::uint32_t>(__builtin_ctzll(mask));
+    }
+};
+
+template <std::uint32_t N>
+struct min_block<std::uint64_t, N>
+{
+    static constexpr bool vectorized = (N % 8u == 0u);
+
+    static inline __attribute__((always_inline)) std::uint32_t find(const std::uint64_t* p, std::uint64_t& out) noexcept
+    {
+        // AVX2 has no unsigned 64-bit min: bias into the signed domain and
+        // select with a signed compare.
+        constexpr std::uint32_t lanes = N / 4u;
+        const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(1ull << 63));
+        __m256i v[lanes];
+        v[0] = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), bias);
+        __m256i m = v[0];
+        for (std::uint32_t k = 1u; k < lanes; ++k) {
+            v[k] = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 4u * k)), bias);
+            m = _mm256_blendv_epi8(m, v[k], _mm256_cmpgt_epi64(m, v[k]));
+        }
+        __m256i s = _mm256_permute2x128_si256(m, m, 1);
+        m = _mm256_blendv_epi8(m, s, _mm256_cmpgt_epi64(m, s));
+        s = _mm256_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2));
+        m = _mm256_blendv_epi8(m, s, _mm256_cmpgt_epi64(m, s));
+        out = static_cast<std::uint64_t>(_mm256_extract_epi64(m, 0)) ^ (1ull << 63);
+        std::uint64_t mask = 0u;
+        for (std::uint32_t k = 0u; k < lanes; ++k)
+            mask |= static_cast<std::uint64_t>(static_cast<unsigned>(
+                        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v[k], m)))))
+                    << (4u * k);
+        return static_cast<std::uint32_t>(__builtin_ctzll(mask));
+    }
+};
+
+template <std::uint32_t N>
+struct above_block<int, N>
+{
+    static constexpr bool vectorized = (N % 8u == 0u);
+
+    static inline __attribute__((always_inline)) std::uint64_t mask(const int* p, int t) noexcept
+    {
+        const __m256i b = _mm256_set1_epi32(t);
+        std::uint64_t m = 0u;
+        for (std::uint32_t k = 0u; k < N / 8u; ++k) {
+            const __m256i gt = _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8u * k)), b);
+            m |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(gt)))) << (8u * k);
+        }
+        return m;
+    }
+};
+
+#elif NHPQ_MINHEAP_SIMD && defined(__SSE4_1__)
+
+template <std::uint32_t N>
+struct min_block<int, N>
+{
+    static constexpr bool vectorized = (N % 4u == 0u);
+
+    static inline __attribute__((always_inline)) std::uint32_t find(const int* p, int& out) noexcept
+    {
+        constexpr std::uint32_t lanes = N / 4u;
+        __m128i v[lanes];
+        v[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i m = v[0];
+        for (std::uint32_t k = 1u; k < lanes; ++k) {
+            v[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4u * k));
+            m = _mm_min_epi32(m, v[k]);
+        }
+        m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        out = _mm_cvtsi128_si32(m);
+        std::uint64_t mask = 0u;
+        for (std::uint32_t k = 0u; k < lanes; ++k)
+            mask |= static_cast<std::uint64_t>(static_cast<unsigned>(
+                        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v[k], m)))))
+                    << (4u * k);
+        return static_cast<std::uint32_t>(__builtin_ctzll(mask));
+    }
+};
+
+template <std::uint32_t N>
+struct above_block<int, N>
+{
+    static constexpr bool vectorized = (N % 4u == 0u);
+
+    static inline __attribute__((always_inline)) std::uint64_t mask(const int* p, int t) noexcept
+    {
+        const __m128i b = _mm_set1_epi32(t);
+        std::uint64_t m = 0u;
+        for (std::uint32_t k = 0u; k < N / 4u; ++k) {
+            const __m128i gt = _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4u * k)), b);
+            m |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(gt)))) << (4u * k);
+        }
+        return m;
+    }
+};
+
+#endif
+
+// the kernel block_min<N> runs on T keys: isa, or "scalar" for the fallback
+template <class T, std::uint32_t N>
+inline constexpr const char* kernel = min_block<T, N>::vectorized ? isa : "scalar";
+
+// offset of the first minimum of the full block p[0..N-1] of at most 64 keys,
+// stored in `out`: one SIMD kernel where available, an unrolled scalar scan otherwise.
+template <std::uint32_t N, class T>
+inline __attribute__((always_inline)) std::uint32_t block_min(const T* __restrict p, T& out) noexcept
+{
+    static_assert(N <= 64u, "one mask bit per key");
+    if constexpr (min_block<T, N>::vectorized) {
+        return min_block<T, N>::find(p, out);
+    } else {
+        std::uint32_t b = 0u;
+        T bv = p[0];
+#pragma GCC unroll 16
+        for (std::uint32_t i = 1u; i < N; ++i) {
+            const T v = p[i];
+            if (v < bv) {
+                b = i;
+                bv = v;
+            }
+        }
+        out = bv;
+        return b;
+    }
+}
+
+// bit i set when p[i] > t, for the block p[0..N-1] of at most 64 keys
+template <std::uint32_t N, class T>
+inline __attribute__((always_inline)) std::uint64_t block_above(const T* __restrict p, T t) noexcept
+{
+    static_assert(N <= 64u, "one mask bit per key");
+    if constexpr (above_block<T, N>::vectorized) {
+        return above_block<T, N>::mask(p, t);
+    } else {
+        // most blocks are rejected whole: a max reduction (which the
+        // compiler vectorizes) decides that before any mask is built
+        T mx = p[0];
+        for (std::uint32_t i = 1u; i < N; ++i)
+            mx = p[i] > mx ? p[i] : mx;
+        if (!(mx > t))
+            return 0u;
+        std::uint64_t m = 0u;
+        for (std::uint32_t i = 0u; i < N; ++i)
+            m |= static_cast<std::uint64_t>(p[i] > t) << i;
+        return m;
+    }
+}
+
+} // namespace minheap_simd
@@ -0,0 +1,289 @@
+#ifndef MULTIQUEUE_PRIQUEUE
+#define MULTIQUEUE_PRIQUEUE
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "arch_aware_heap.h"
+
+// elements a thread buffers locally before it touches a shard
+#ifndef MULTIQUEUE_BUFFER
+#define MULTIQUEUE_BUFFER 16
+#endif
+
+// relaxed concurrent min-priority queue (MultiQueue, Rihani/Sanders/Dementiev,
+// with the buffering of Williams/Sanders/Dementiev "Engineering MultiQueues").
+//
+// - c*P shards, each a growable MinHeapT behind a one-byte try-lock; the top
+//   key of every shard is mirrored in an atomic, so shards are compared
+//   without taking their locks;
+// - threads work through a handle that owns an insertion buffer (flushed to
+//   a random shard with push_bulk) and a deletion buffer (refilled with
+//   pop_n from the better of two random shards);
+// - a pop returns the smaller of the local insertion buffer minimum and the
+//   deletion buffer head, so a thread never sees its own keys out of order.
+//
+// Pops are relaxed: the returned key is usually close to, but not always,
+// the global minimum. Keys use heap_key_traits, the largest Key value is
+// reserved as the "empty shard" marker.
+template <typename Key = int, uint32_t Arity = NHPQ_MINHEAP_ARITY>
+class multiqueue_priqueue {
+
+public:
+    typedef Key key_type;
+    static constexpr size_t buffer_size = MULTIQUEUE_BUFFER;
+
+private:
+    typedef MinHeapT<Arity, Key> heap_type;
+
+    static constexpr Key empty_top = std::numeric_limits<Key>::max();
+
+    struct alignas(64) shard {
+        std::atomic<bool> locked{false};
+        std::atomic<Key> top{empty_top};
+        std::atomic<size_t> size{0};
+        heap_type heap;
+
+        explicit shard(uint32_t max_elements) : heap(heap_growable, max_elements) {}
+
+        bool try_lock() {
+            return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock() {
+            top.store(heap.empty() ? empty_top : heap.top(), std::memory_order_relaxed);
+            size.store(heap.size(), std::memory_order_relaxed);
+            locked.store(false, std::memory_order_release);
+        }
+    };
+
+    std::vector<std::unique_ptr<shard>> shards;
+    std::atomic<uint64_t> next_seed{0x9E3779B97F4A7C15ull};
+
+public:
+    // per-thread access point; not shareable between threads
+    class handle {
+        friend class multiqueue_priqueue;
+
+        multiqueue_priqueue * q;
+        uint64_t rng;
+        std::vector<Key> ins;   // unsorted, at most buffer_size
+        std::vector<Key> del;   // sorted, consumed from del_head
+        size_t del_head = 0;
+
+        handle(multiqueue_priqueue * q, uint64_t seed) : q(q), rng(seed) {
+            ins.reserve(buffer_size);
+            del.reserve(buffer_size);
+        }
+
+        // xorshift64*
+        size_t random_shard() {
+            rng ^= rng >> 12;
+            rng ^= rng << 25;
+            rng ^= rng >> 27;
+            return static_cast<size_t>(((rng * 0x2545F4914F6CDD1Dull) >> 32) % q->shards.size());
+        }
+
+        shard & lock_random() {
+            for (;;) {
+                shard & s = *q->shards[random_shard()];
+                if (s.try_lock())
+                    return s;
+            }
+        }
+
+        // two-choice refill of the deletion buffer; false when both samples were empty
+        bool refill() {
+            for (int attempt = 0; attempt < 4; attempt++) {
+                shard & a = *q->shards[random_shard()];
+                shard & b = *q->shards[random_shard()];
+                shard & s = (b.top.load(std::memory_order_relaxed) < a.top.load(std::memory_order_relaxed)) ? b : a;
+                if (s.top.load(std::memory_order_relaxed) == empty_top)
+                    continue;
+                if (!s.try_lock())
+                    continue;
+                del.resize(buffer_size);
+                del.resize(s.heap.pop_n(del.data(), buffer_size));
+                del_head = 0;
+                s.unlock();
+                if (!del.empty())
+                    return true;
+            }
+            return false;
+        }
+
+    public:
+        handle(handle &&) = default;
+        handle & operator=(handle &&) = default;
+
+        void push(Key key) {
+            assert(key != empty_top);
+            ins.push_back(key);
+            if (ins.size() == buffer_size)
+                flush();
+        }
+
+        // hand the insertion buffer to a random shard
+        void flush() {
+            if (ins.empty())
+                return;
+            shard & s = lock_random();
+            const bool ok = s.heap.push_bulk(ins.data(), ins.size());
+            assert(ok);
+            (void)ok;
+            s.unlock();
+            ins.clear();
+        }
+
+        // the smallest locally visible key; false if none was found
+        bool try_pop(Key & out) {
+            if (del_head == del.size())
+                refill();
+            const auto it = std::min_element(ins.begin(), ins.end());
+            const bool from_del = del_head != del.size();
+            if (it != ins.end() && (!from_del || *it < del[del_head])) {
+                out = *it;
+                *it = ins.back();
+                ins.pop_back();
+                return true;
+            }
+            if (!from_del)
+                return false;
+            out = del[del_head++];
+            return true;
+        }
+
+        // elements held by this handle's buffers
+        size_t buffered() const {
+            return ins.size() + del.size() - del_head;
+        }
+    };
+
+    // shards = c * threads, each able to hold max_elements
+    multiqueue_priqueue(unsigned threads, unsigned c, uint32_t max_elements) {
+        const size_t n = std::max<size_t>(2, size_t(std::max(1u, c)) * std::max(1u, threads));
+        shards.reserve(n);
+        for (size_t k = 0; k < n; k++)
+            shards.push_back(std::make_unique<shard>(max_elements));
+    }
+
+    handle get_handle() {
+        return handle(this, next_seed.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed) | 1u);
+    }
+
+    // elements in the shards (excludes handle buffers; exact only when quiescent)
+    size_t size() const {
+        size_t n = 0;
+        for (const auto & s : shards)
+            n += s->size.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t shard_count() const {
+        return shards.size();
+    }
+};
+
+// sequential front end for the single-threaded workloads: one handle used by
+// the calling thread, with the usual push/top/pop/size/empty interface
+template <typename Key = int, uint32_t Arity = NHPQ_MINHEAP_ARITY>
+class multiqueue_seq_priqueue {
+
+    typedef multiqueue_priqueue<Key, Arity> queue_type;
+
+    queue_type q;
+    typename queue_type::handle h;
+    Key head;
+    bool has_head = false;
+
+    void fetch() {
+        // a single thread sees every shard unlocked, so only sampling can miss
+        while (!has_head)
+            has_head = h.try_pop(head);
+    }
+
+public:
+    multiqueue_seq_priqueue(unsigned threads, unsigned c, uint32_t max_elements) :
+        q(threads, c, max_elements), h(q.get_handle()) {}
+
+    size_t size() const {
+        return q.size() + h.buffered() + (has_head ? 1 : 0);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t shard_count() const {
+        return q.shard_count();
+    }
+
+    void push(const Key key) {
+        h.push(key);
+    }
+
+    const Key & top() {
+        fetch();
+        return head;
+    }
+
+    void pop() {
+        fetch();
+        has_head = false;
+    }
+};
+
+// a sequential queue behind one mutex, handing out handles like the
+// MultiQueue; the strict baseline of the multi-threaded workload
+template <typename PQ, typename Key>
+class locked_priqueue {
+
+    PQ & pq;
+    std::mutex m;
+
+public:
+    typedef Key key_type;
+
+    class handle {
+        friend class locked_priqueue;
+        locked_priqueue * q;
+        explicit handle(locked_priqueue * q) : q(q) {}
+
+    public:
+        void push(const key_type key) {
+            std::lock_guard<std::mutex> lk(q->m);
+            q->pq.push(key);
+        }
+
+        void flush() {}
+
+        bool try_pop(key_type & out) {
+            std::lock_guard<std::mutex> lk(q->m);
+            if (q->pq.empty())
+                return false;
+            out = q->pq.top();
+            q->pq.pop();
+            return true;
+        }
+    };
+
+    explicit locked_priqueue(PQ & pq) : pq(pq) {}
+
+    handle get_handle() {
+        return handle(this);
+    }
+};
+
+#endif //MULTIQUEUE_PRIQUEUE
@@ -0,0 +1,105 @@
+#ifndef NODE_MEMORY_H
+#define NODE_MEMORY_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// memory resources for the node-based candidates (B, C, D), so the cost of
+// the allocator can be told apart from the cost of the data structure:
+//
+// - new:   std::pmr::new_delete_resource(), i.e. one malloc per node;
+// - slab:  slab_resource below: size-class free lists carved from 1 MiB
+//          slabs, so freed nodes are reused LIFO and live nodes stay dense;
+// - arena: std::pmr::monotonic_buffer_resource, bump allocation that never
+//          reuses memory (only freed when the queue is gone);
+// - pool:  std::pmr::unsynchronized_pool_resource, the library's pooling
+//          resource, for comparison with slab.
+//
+// None of them is thread-safe; the multi-threaded modes serialize queue
+// access anyway.
+namespace node_mem {
+
+class slab_resource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t granule = 8;       // size classes are multiples of this
+    static constexpr size_t max_small = 512;   // larger requests go upstream
+    static constexpr size_t slab_bytes = size_t(1) << 20;
+
+private:
+    struct free_node {
+        free_node * next;
+    };
+
+    std::pmr::memory_resource * const upstream;
+    std::array<free_node *, max_small / granule> free_lists{};
+    std::vector<void *> slabs;
+    char * cur = nullptr;
+    char * end = nullptr;
+
+    static size_t size_class(size_t bytes) {
+        return (std::max<size_t>(bytes, 1) + granule - 1) / granule - 1;
+    }
+
+    // bump-allocate from the current slab; the tail of a full slab is dropped
+    void * carve(size_t bytes) {
+        if (static_cast<size_t>(end - cur) < bytes) {
+            cur = static_cast<char *>(upstream->allocate(slab_bytes, 64));
+            end = cur + slab_bytes;
+            slabs.push_back(cur);
+        }
+        void * p = cur;
+        cur += bytes;
+        return p;
+    }
+
+    void * do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes > max_small || alignment > granule)
+            return upstream->allocate(bytes, alignment);
+        const size_t c = size_class(bytes);
+        if (free_node * n = free_lists[c]) {
+            free_lists[c] = n->next;
+            return n;
+        }
+        return carve((c + 1) * granule);
+    }
+
+    void do_deallocate(void * p, size_t bytes, size_t alignment) override {
+        if (bytes > max_small || alignment > granule) {
+            upstream->deallocate(p, bytes, alignment);
+            return;
+        }
+        const size_t c = size_class(bytes);
+        free_node * n = static_cast<free_node *>(p);
+        n->next = free_lists[c];
+        free_lists[c] = n;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit slab_resource(std::pmr::memory_resource * upstream = std::pmr::new_delete_resource()) :
+        upstream(upstream) {}
+
+    slab_resource(const slab_resource &) = delete;
+    slab_resource & operator=(const slab_resource &) = delete;
+
+    ~slab_resource() override {
+        for (void * s : slabs)
+            upstream->deallocate(s, slab_bytes, 64);
+    }
+
+    // bytes taken from upstream for slabs (excludes large requests)
+    size_t reserved_bytes() const {
+        return slabs.size() * slab_bytes;
+    }
+};
+
+} // namespace node_mem
+
+#endif // NODE_MEMORY_H
@@ -0,0 +1,305 @@
+#ifndef OP_TRACE_H
+#define OP_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// recorded priority queue op streams (push(key) / pop / top), so every
+// candidate can be driven by a byte-identical sequence of operations, and
+// streams captured from other schedulers can be replayed.
+//
+// File layout (native endianness, every section 64-byte aligned):
+//   file_header | ops: uint8[op_num] | keys: int32[key_num]
+//
+// Every op is one byte; the i-th op_push takes the i-th key, op_pop and
+// op_top take none, so the replay loop only walks two arrays. A trace is
+// checked once when it is opened (opcodes, no pop/top on an empty queue, one
+// key per push); the replay itself does no parsing. On Linux the file is
+// mapped read-only; Windows reads it into owned arrays.
+namespace op_trace {
+
+constexpr uint32_t format_version = 1;
+constexpr uint64_t section_align = 64;
+
+enum op : uint8_t {
+    op_push = 0, // push the next key
+    op_pop = 1,  // remove the minimum (its key is folded into the checksum)
+    op_top = 2,  // read the minimum
+};
+
+struct file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t key_bytes;
+    uint64_t op_num;
+    uint64_t key_num;
+    uint64_t ops_at;
+    uint64_t keys_at;
+    uint64_t file_bytes;
+};
+
+inline constexpr char magic[8] = {'N', 'H', 'P', 'Q', 'T', 'R', 'C', 'E'};
+
+inline uint64_t align_up(uint64_t n) {
+    return (n + section_align - 1) / section_align * section_align;
+}
+
+inline file_header make_header(uint64_t op_num, uint64_t key_num) {
+    file_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = format_version;
+    h.key_bytes = sizeof(int32_t);
+    h.op_num = op_num;
+    h.key_num = key_num;
+    h.ops_at = align_up(sizeof(file_header));
+    h.keys_at = align_up(h.ops_at + op_num);
+    h.file_bytes = h.keys_at + key_num * sizeof(int32_t);
+    return h;
+}
+
+// order-sensitive checksum of the keys seen by pop and top, equal for every
+// strict candidate replaying the same trace
+inline uint64_t fold(uint64_t h, int32_t key) {
+    return (h ^ static_cast<uint32_t>(key)) * 0x100000001B3ull;
+}
+
+constexpr uint64_t fold_seed = 0xCBF29CE484222325ull;
+
+// collects an op stream in memory and writes it as one trace file
+class writer {
+    std::vector<uint8_t> ops;
+    std::vector<int32_t> keys;
+    uint64_t live = 0;
+
+public:
+    void reserve(size_t op_num, size_t key_num) {
+        ops.reserve(op_num);
+        keys.reserve(key_num);
+    }
+
+    void push(int32_t key) {
+        ops.push_back(op_push);
+        keys.push_back(key);
+        live++;
+    }
+
+    void pop() {
+        ops.push_back(op_pop);
+        live--;
+    }
+
+    void top() {
+        ops.push_back(op_top);
+    }
+
+    uint64_t op_count() const { return ops.size(); }
+    uint64_t key_count() const { return keys.size(); }
+    uint64_t size() const { return live; }
+
+    // written to a temporary name first and renamed, like graph_cache::save
+    bool save(const std::string & path) const {
+        std::error_code ec;
+        const std::filesystem::path target(path);
+        if (target.has_parent_path())
+            std::filesystem::create_directories(target.parent_path(), ec);
+
+        const file_header h = make_header(ops.size(), keys.size());
+        const std::string tmp = path + ".tmp";
+        FILE * f = std::fopen(tmp.c_str(), "wb");
+        if (!f)
+            return false;
+
+        static const char zeros[section_align] = {};
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+        ok = ok && std::fwrite(zeros, 1, h.ops_at - sizeof(h), f) == h.ops_at - sizeof(h);
+        ok = ok && std::fwrite(ops.data(), 1, ops.size(), f) == ops.size();
+        const uint64_t pad = h.keys_at - (h.ops_at + ops.size());
+        ok = ok && std::fwrite(zeros, 1, pad, f) == pad;
+        ok = ok && std::fwrite(keys.data(), sizeof(int32_t), keys.size(), f) == keys.size();
+        ok = (std::fclose(f) == 0) && ok;
+        if (ok)
+            std::filesystem::rename(tmp, target, ec);
+        if (!ok || ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+};
+
+// a checked, read-only trace; empty (valid() == false) when opening failed,
+// with the reason in error()
+class trace {
+    std::shared_ptr<const void> storage;
+    const uint8_t * ops = nullptr;
+    const int32_t * keys_ = nullptr;
+    uint64_t op_num = 0;
+    uint64_t key_num = 0;
+    uint64_t peak = 0;
+    uint64_t pops = 0;
+    std::string why;
+
+    bool fail(const char * msg) {
+        *this = trace();
+        why = msg;
+        return false;
+    }
+
+    // one pass over the ops: opcodes, no pop/top on an empty queue, one key per push
+    bool check() {
+        uint64_t live = 0, pushes = 0;
+        for (uint64_t k = 0; k < op_num; k++) {
+            switch (ops[k]) {
+            case op_push:
+                pushes++;
+                live++;
+                peak = live > peak ? live : peak;
+                break;
+            case op_pop:
+                if (live == 0)
+                    return fail("trace pops an empty queue");
+                live--;
+                pops++;
+                break;
+            case op_top:
+                if (live == 0)
+                    return fail("trace reads the top of an empty queue");
+                break;
+            default:
+                return fail("trace has an unknown opcode");
+            }
+        }
+        if (pushes != key_num)
+            return fail("trace key count does not match its pushes");
+        return true;
+    }
+
+public:
+    trace() = default;
+
+    static trace open(const std::string & path) {
+        trace t;
+        t.map(path);
+        return t;
+    }
+
+    bool valid() const { return ops != nullptr; }
+    const std::string & error() const { return why; }
+
+    const uint8_t * ops_begin() const { return ops; }
+    const uint8_t * ops_end() const { return ops + op_num; }
+    const int32_t * keys() const { return keys_; }
+    uint64_t op_count() const { return op_num; }
+    uint64_t key_count() const { return key_num; }
+    uint64_t pop_count() const { return pops; }
+    // largest queue size reached, the capacity a fixed-size candidate needs
+    uint64_t max_size() const { return peak; }
+
+private:
+    bool header_ok(const file_header & h, uint64_t file_bytes) {
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0)
+            return fail("not a trace file");
+        if (h.version != format_version || h.key_bytes != sizeof(int32_t))
+            return fail("unsupported trace version or key width");
+        const file_header want = make_header(h.op_num, h.key_num);
+        if (h.ops_at != want.ops_at || h.keys_at != want.keys_at || h.file_bytes != want.file_bytes ||
+            h.file_bytes != file_bytes)
+            return fail("trace file is truncated or corrupt");
+        return true;
+    }
+
+    bool map(const std::string & path) {
+#if defined(_WIN32)
+        FILE * f = std::fopen(path.c_str(), "rb");
+        if (!f)
+            return fail("cannot open trace file");
+        file_header h;
+        std::error_code ec;
+        const uint64_t bytes = std::filesystem::file_size(path, ec);
+        if (ec || std::fread(&h, sizeof(h), 1, f) != 1 || !header_ok(h, bytes)) {
+            std::fclose(f);
+            return why.empty() ? fail("cannot read trace header") : false;
+        }
+        auto buf = std::shared_ptr<char>(new char[h.file_bytes], std::default_delete<char[]>());
+        const bool ok = _fseeki64(f, 0, SEEK_SET) == 0 && std::fread(buf.get(), 1, h.file_bytes, f) == h.file_bytes;
+        std::fclose(f);
+        if (!ok)
+            return fail("cannot read trace file");
+        const char * base = buf.get();
+        storage = std::move(buf);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return fail("cannot open trace file");
+        struct stat st;
+        file_header h;
+        if (::fstat(fd, &st) != 0 || ::pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))) {
+            ::close(fd);
+            return fail("cannot read trace header");
+        }
+        if (!header_ok(h, static_cast<uint64_t>(st.st_size))) {
+            ::close(fd);
+            return false;
+        }
+
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        // fault the file in now, not during the timed replay
+        flags |= MAP_POPULATE;
+#endif
+        void * p = ::mmap(nullptr, h.file_bytes, PROT_READ, flags, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return fail("cannot map trace file");
+        const uint64_t len = h.file_bytes;
+        storage = std::shared_ptr<const void>(p, [len](const void * q) { ::munmap(const_cast<void *>(q), len); });
+        const char * base = static_cast<const char *>(p);
+#endif
+        ops = reinterpret_cast<const uint8_t *>(base + h.ops_at);
+        keys_ = reinterpret_cast<const int32_t *>(base + h.keys_at);
+        op_num = h.op_num;
+        key_num = h.key_num;
+        return check();
+    }
+};
+
+// drive `pq` with the whole trace; returns the fold() checksum of the keys
+// seen by pop and top
+template <typename PQ>
+uint64_t replay(PQ & pq, const trace & t) {
+    const int32_t * key = t.keys();
+    uint64_t h = fold_seed;
+    for (const uint8_t * op = t.ops_begin(), * end = t.ops_end(); op != end; ++op) {
+        switch (*op) {
+        case op_push:
+            pq.push(*key++);
+            break;
+        case op_pop:
+            h = fold(h, pq.top());
+            pq.pop();
+            break;
+        default:
+            h = fold(h, pq.top());
+            break;
+        }
+    }
+    return h;
+}
+
+} // namespace op_trace
+
+#endif // OP_TRACE_H
@@ -2,23 +2,41 @@
 #define PAIRING_HEAP_PRIQUEUE
 
 #include <cassert>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
 #include <stack>
+#include <utility>
 
+// `prev` is the previous sibling, or the parent for a leftmost child, so a
+// node can be cut out of its sibling list in O(1) for decrease_key
 template <typename T>
 struct heap_node {
-    const T key;
+    T key;
     heap_node<T> * left_child = nullptr;
     heap_node<T> * next_sibling = nullptr;
+    heap_node<T> * prev = nullptr;
 
-    heap_node(const T key) : key(key)  {}
+    heap_node(T key) : key(std::move(key))  {}
 
-    void add_child(heap_node<T> *& node) {
-        if (left_child!=nullptr){
-            std::swap(node->next_sibling,left_child);
-            std::swap(left_child,node);
-        } else {
-            std::swap(left_child,node);
-        }
+    void add_child(heap_node<T> * node) {
+        node->next_sibling = left_child;
+        if (left_child != nullptr)
+            left_child->prev = node;
+        node->prev = this;
+        left_child = node;
+    }
+
+    // detach this (non-root) subtree from its parent's child list
+    void cut(void) {
+        if (prev->left_child == this)
+            prev->left_child = next_sibling;
+        else
+            prev->next_sibling = next_sibling;
+        if (next_sibling != nullptr)
+            next_sibling->prev = prev;
+        next_sibling = nullptr;
+        prev = nullptr;
     }
 };
 
@@ -33,18 +51,28 @@ struct two_pass_ret {
 template <typename T>
 class pairing_heap_priqueue {
 
+public:
+    // stable until the element is popped
+    typedef heap_node<T> * handle_type;
+
 private:
     typedef T key_type;
+    // nodes come from here (see node_memory.h)
+    std::pmr::memory_resource * const mr;
     heap_node<key_type> * root = nullptr;
     size_t total_num = 0;
 
+    heap_node<T> * new_node(T key) {
+        return new (mr->allocate(sizeof(heap_node<T>), alignof(heap_node<T>))) heap_node<T>(std::move(key));
+    }
 
-    heap_node<T> * insert(heap_node<T> * node, const T key){
-        auto * node_ptr = new heap_node(key);
-        return merge(node, node_ptr);
+    void delete_node(heap_node<T> * node) {
+        node->~heap_node<T>();
+        mr->deallocate(node, sizeof(heap_node<T>), alignof(heap_node<T>));
     }
 
-    inline heap_node<T> * & merge(heap_node<T> *&A, heap_node<T> *&B) {
+
+    inline heap_node<T> * merge(heap_node<T> *A, heap_node<T> *B) {
  
         // If any of the two-nodes is None
         // then return the not None node
@@ -65,7 +93,7 @@ private:
         return B;
     }
 
-    heap_node<T> * erase(heap_node<T> * & node) {
+    heap_node<T> * erase(heap_node<T> * node) {
         
         heap_node<T> * cur_node = node->left_child;
         heap_node<T> * merge_node = nullptr;
@@ -78,11 +106,14 @@ private:
         }
 
         
-        delete node; // remove node
-        return merge(cur_node,merge_node); // return node
+        delete_node(node); // remove node
+        heap_node<T> * new_root = merge(cur_node,merge_node);
+        if (new_root != nullptr)
+            new_root->prev = nullptr;
+        return new_root; // return node
     }
 
-    inline heap_node<T> * two_pass_merge(heap_node<T> *& merge_node, heap_node<T> *& node) {
+    inline heap_node<T> * two_pass_merge(heap_node<T> *& merge_node, heap_node<T> * node) {
 
         auto B = node->next_sibling;
         auto new_node = node->next_sibling->next_sibling;
@@ -96,6 +127,26 @@ private:
         
 
 public:
+
+    explicit pairing_heap_priqueue(std::pmr::memory_resource * mr = std::pmr::get_default_resource()) : mr(mr) {}
+    pairing_heap_priqueue(const pairing_heap_priqueue &) = delete;
+    pairing_heap_priqueue & operator=(const pairing_heap_priqueue &) = delete;
+
+    ~pairing_heap_priqueue() {
+        // free the remaining nodes without recursion
+        std::stack<heap_node<T> *> pending;
+        if (root != nullptr)
+            pending.push(root);
+        while (!pending.empty()) {
+            heap_node<T> * node = pending.top();
+            pending.pop();
+            if (node->left_child != nullptr)
+                pending.push(node->left_child);
+            if (node->next_sibling != nullptr)
+                pending.push(node->next_sibling);
+            delete_node(node);
+        }
+    }
     
     size_t size(void) const {
         return total_num;
@@ -105,9 +156,12 @@ public:
         return total_num == 0;
     } 
 
-    void push(const key_type key) {
-        root = insert(root,key);
+    // the key is moved into its node, so move-only keys work too
+    handle_type push(key_type key) {
+        auto * node = new_node(std::move(key));
+        root = merge(root, node);
         total_num++;
+        return node;
     }
 
     void pop(void) {
@@ -121,6 +175,29 @@ public:
         return root->key;
     }
 
+    // lower the key of a queued element: its subtree is cut out and merged
+    // back at the root
+    void decrease_key(handle_type node, const key_type key) {
+        assert(!(node->key < key));
+        node->key = key;
+        if (node == root)
+            return;
+        node->cut();
+        root = merge(root, node);
+    }
+
+    // move all elements of `other` into this heap in O(1); handles stay valid.
+    // Both heaps must allocate from the same memory resource.
+    void meld(pairing_heap_priqueue & other) {
+        if (&other == this)
+            return;
+        assert(mr->is_equal(*other.mr));
+        root = merge(root, other.root);
+        total_num += other.total_num;
+        other.root = nullptr;
+        other.total_num = 0;
+    }
+
 };
 
 
@@ -0,0 +1,185 @@
+#ifndef PARALLEL_UTIL_H
+#define PARALLEL_UTIL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// small std::thread helpers for the benchmark setup code (graph generation
+// and friends) and the parallel search modes. Work is always split into the
+// same contiguous chunks for a given thread count, and the results of the
+// parallel_* algorithms below are independent of it.
+namespace par {
+
+inline unsigned default_threads() {
+    const unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// [begin, end) of chunk t when n items are split into `chunks` parts
+inline size_t chunk_begin(size_t n, unsigned chunks, unsigned t) {
+    return n / chunks * t + std::min<size_t>(t, n % chunks);
+}
+
+// run fn(t, begin, end) for each of `threads` contiguous chunks of [0, n)
+template <typename Fn>
+void parallel_for(unsigned threads, size_t n, Fn fn) {
+    threads = std::max(1u, threads);
+    if (threads == 1) {
+        fn(0u, size_t(0), n);
+        return;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(fn, t, chunk_begin(n, threads, t), chunk_begin(n, threads, t + 1));
+    fn(0u, size_t(0), chunk_begin(n, threads, 1));
+    for (auto & th : pool)
+        th.join();
+}
+
+// sort each chunk in parallel, then merge neighbouring chunks pairwise
+template <typename T, typename Cmp>
+void parallel_sort(std::vector<T> & v, unsigned threads, Cmp cmp) {
+    threads = std::max(1u, std::min<unsigned>(threads, std::max<size_t>(1, v.size() / 4096)));
+    parallel_for(threads, v.size(), [&](unsigned, size_t b, size_t e) {
+        std::sort(v.begin() + b, v.begin() + e, cmp);
+    });
+    for (unsigned width = 1; width < threads; width *= 2) {
+        const unsigned pairs = (threads + 2 * width - 1) / (2 * width);
+        parallel_for(pairs, pairs, [&](unsigned, size_t pb, size_t pe) {
+            for (size_t p = pb; p < pe; p++) {
+                const unsigned lo = static_cast<unsigned>(p) * 2 * width;
+                const unsigned mid = std::min(lo + width, threads);
+                const unsigned hi = std::min(lo + 2 * width, threads);
+                if (mid < hi)
+                    std::inplace_merge(v.begin() + chunk_begin(v.size(), threads, lo),
+                                       v.begin() + chunk_begin(v.size(), threads, mid),
+                                       v.begin() + chunk_begin(v.size(), threads, hi), cmp);
+            }
+        });
+    }
+}
+
+// stable parallel compaction: keep v[i] when keep(i) holds
+template <typename T, typename Keep>
+void parallel_compact(std::vector<T> & v, unsigned threads, Keep keep) {
+    threads = std::max(1u, threads);
+    std::vector<size_t> counts(threads + 1, 0);
+    parallel_for(threads, v.size(), [&](unsigned t, size_t b, size_t e) {
+        size_t c = 0;
+        for (size_t i = b; i < e; i++)
+            c += keep(i) ? 1 : 0;
+        counts[t + 1] = c;
+    });
+    for (unsigned t = 0; t < threads; t++)
+        counts[t + 1] += counts[t];
+    std::vector<T> out(counts[threads]);
+    parallel_for(threads, v.size(), [&](unsigned t, size_t b, size_t e) {
+        size_t o = counts[t];
+        for (size_t i = b; i < e; i++)
+            if (keep(i))
+                out[o++] = v[i];
+    });
+    v.swap(out);
+}
+
+// sense-reversing barrier for short, frequent phases; waiters spin with
+// yield so oversubscribed runs still make progress
+class spin_barrier {
+    const unsigned n;
+    std::atomic<unsigned> waiting{0};
+    std::atomic<unsigned> phase{0};
+public:
+    explicit spin_barrier(unsigned n) : n(n) {}
+
+    void arrive_and_wait() {
+        const unsigned ph = phase.load(std::memory_order_acquire);
+        if (waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == n) {
+            waiting.store(0, std::memory_order_relaxed);
+            phase.fetch_add(1, std::memory_order_release);
+        } else {
+            while (phase.load(std::memory_order_acquire) == ph)
+                std::this_thread::yield();
+        }
+    }
+};
+
+// persistent workers: run(fn) calls fn(t) on threads 0..size()-1 and returns
+// once all are done. Thread 0 is the caller; the others sleep between runs.
+class thread_pool {
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable cv;
+    std::function<void(unsigned)> job;
+    uint64_t generation = 0;
+    unsigned running = 0;
+    bool stop = false;
+
+    void loop(unsigned t) {
+        uint64_t seen = 0;
+        for (;;) {
+            std::function<void(unsigned)> fn;
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&] { return stop || generation != seen; });
+                if (stop)
+                    return;
+                seen = generation;
+                fn = job;
+            }
+            fn(t);
+            std::lock_guard<std::mutex> lk(m);
+            if (--running == 0)
+                cv.notify_all();
+        }
+    }
+
+public:
+    explicit thread_pool(unsigned threads) {
+        threads = std::max(1u, threads);
+        workers.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; t++)
+            workers.emplace_back(&thread_pool::loop, this, t);
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto & w : workers)
+            w.join();
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool & operator=(const thread_pool &) = delete;
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    void run(std::function<void(unsigned)> fn) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            job = fn;
+            running = static_cast<unsigned>(workers.size());
+            generation++;
+        }
+        cv.notify_all();
+        fn(0);
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&] { return running == 0; });
+    }
+};
+
+} // namespace par
+
+#endif // PARALLEL_UTIL_H
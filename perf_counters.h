@@ -0,0 +1,164 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// hardware (and a few software) counters of the calling thread around a
+// region, through perf_event_open counter groups (Linux only).
+//
+// The events are opened once, in three groups whose members are always
+// scheduled together, so ratios inside a group (e.g. instructions per
+// cycle) stay exact even when the kernel multiplexes the groups:
+//
+//   cycles, instructions, branch_misses
+//   l1d_misses (loads), llc_misses (loads), dtlb_misses (loads)
+//   page_faults, context_switches
+//
+// User space only (exclude_kernel), which works with the default
+// perf_event_paranoid=2. Events the machine does not offer (VMs without a
+// virtual PMU, missing cache events) are dropped and listed by missing();
+// multiplexed counts are scaled by time_enabled / time_running.
+namespace perf_counters {
+
+struct reading {
+    const char * name;
+    uint64_t value;
+    double running; // fraction of the region the group was on the PMU
+};
+
+#if defined(__linux__)
+
+class group_set {
+    struct event_spec {
+        const char * name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    struct group {
+        int leader = -1;
+        std::vector<int> fds;
+        std::vector<const char *> names;
+    };
+
+    std::vector<group> groups;
+    std::string missing_events;
+
+    static constexpr uint64_t cache_miss(uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    static int open_event(const event_spec & e, int group_fd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = e.type;
+        attr.config = e.config;
+        attr.disabled = group_fd == -1; // members follow their leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+
+    void open_group(const std::vector<event_spec> & specs) {
+        group g;
+        for (const auto & e : specs) {
+            const int fd = open_event(e, g.leader);
+            if (fd < 0) {
+                missing_events += (missing_events.empty() ? "" : ",") + std::string(e.name);
+                continue;
+            }
+            if (g.leader == -1)
+                g.leader = fd;
+            g.fds.push_back(fd);
+            g.names.push_back(e.name);
+        }
+        if (g.leader != -1)
+            groups.push_back(std::move(g));
+    }
+
+public:
+    group_set() {
+        open_group({{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}});
+        open_group({{"l1d_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+                    {"llc_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+                    {"dtlb_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)}});
+        open_group({{"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+                    {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}});
+    }
+
+    group_set(const group_set &) = delete;
+    group_set & operator=(const group_set &) = delete;
+
+    ~group_set() {
+        for (const auto & g : groups)
+            for (const int fd : g.fds)
+                ::close(fd);
+    }
+
+    bool available() const { return !groups.empty(); }
+
+    // comma-separated events that could not be opened
+    const std::string & missing() const { return missing_events; }
+
+    void start() {
+        for (const auto & g : groups) {
+            ::ioctl(g.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(g.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    void stop() {
+        for (const auto & g : groups)
+            ::ioctl(g.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    // counts since the last start(); groups that never got onto the PMU are left out
+    std::vector<reading> read() const {
+        std::vector<reading> out;
+        for (const auto & g : groups) {
+            // nr, time_enabled, time_running, value[nr]
+            std::vector<uint64_t> buf(3 + g.fds.size());
+            const ssize_t want = static_cast<ssize_t>(buf.size() * sizeof(uint64_t));
+            if (::read(g.leader, buf.data(), want) != want || buf[0] != g.fds.size() || buf[2] == 0)
+                continue;
+            const double running = static_cast<double>(buf[2]) / static_cast<double>(buf[1]);
+            for (size_t k = 0; k < g.fds.size(); k++)
+                out.push_back(reading{g.names[k], static_cast<uint64_t>(buf[3 + k] / running + 0.5), running});
+        }
+        return out;
+    }
+};
+
+#else
+
+class group_set {
+    std::string missing_events = "perf_event_open (not Linux)";
+
+public:
+    bool available() const { return false; }
+    const std::string & missing() const { return missing_events; }
+    void start() {}
+    void stop() {}
+    std::vector<reading> read() const { return {}; }
+};
+
+#endif
+
+} // namespace perf_counters
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,139 @@
+#ifndef RADIX_HEAP_PRIQUEUE
+#define RADIX_HEAP_PRIQUEUE
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "heap_key_traits.h"
+
+// monotone radix heap (Ahuja, Mehlhorn, Orlin, Tarjan). Only valid while
+// every pushed key is >= the last popped key, which holds for Dijkstra with
+// non-negative weights. Keys are bucketed by the highest bit in which they
+// differ from the last popped key; bucket 0 holds copies of that key, so
+// top/pop are O(1) and each element is redistributed at most `bits` times.
+//
+// Key may be uint32_t (integer distances), int, uint64_t or double (via the
+// order-preserving encoding of heap_key_traits.h). Every bucket keeps its
+// keys and payloads in two contiguous vectors, so a redistribution streams
+// through the keys and touches payloads only to move them.
+template <typename Key, typename Payload = void>
+class radix_heap {
+
+public:
+    using key_type = Key;
+    using payload_type = Payload;
+    static constexpr bool has_payload = !std::is_void_v<Payload>;
+
+private:
+    using traits = radix_key_traits<Key>;
+    using radix_type = typename traits::radix_type;
+
+    static constexpr int bits = std::numeric_limits<radix_type>::digits;
+
+    struct no_payload {};
+    using payload_slot = std::conditional_t<has_payload, Payload, no_payload>;
+
+    // refilling bucket 0 happens lazily on top()/pop(), hence mutable
+    mutable std::vector<radix_type> keys[bits + 1];
+    mutable std::vector<payload_slot> payloads[has_payload ? bits + 1 : 1];
+    mutable radix_type last = 0;
+    size_t total_num = 0;
+
+    static inline int bucket_of(radix_type x, radix_type ref) {
+        const radix_type d = x ^ ref;
+        if (d == 0)
+            return 0;
+        if constexpr (sizeof(radix_type) <= sizeof(unsigned))
+            return bits - __builtin_clz(static_cast<unsigned>(d)) - (std::numeric_limits<unsigned>::digits - bits);
+        else
+            return bits - __builtin_clzll(static_cast<unsigned long long>(d));
+    }
+
+    // move the smallest non-empty bucket down so that bucket 0 holds the min
+    void refill() const {
+        int i = 1;
+        while (keys[i].empty())
+            i++;
+
+        auto & ks = keys[i];
+        radix_type m = ks[0];
+        for (const radix_type x : ks)
+            m = x < m ? x : m;
+        last = m;
+
+        for (size_t k = 0; k < ks.size(); k++) {
+            const int b = bucket_of(ks[k], last);
+            assert(b < i);
+            keys[b].push_back(ks[k]);
+            if constexpr (has_payload)
+                payloads[b].push_back(std::move(payloads[i][k]));
+        }
+        ks.clear();
+        if constexpr (has_payload)
+            payloads[i].clear();
+    }
+
+    inline void ensure_top() const {
+        if (keys[0].empty())
+            refill();
+    }
+
+public:
+
+    size_t size(void) const {
+        return total_num;
+    }
+
+    bool empty(void) const {
+        return total_num == 0;
+    }
+
+    template <bool P = has_payload, std::enable_if_t<!P, int> = 0>
+    void push(const key_type key) {
+        const radix_type x = traits::encode(key);
+        assert(x >= last && "radix heap keys must be monotone");
+        keys[bucket_of(x, last)].push_back(x);
+        total_num++;
+    }
+
+    template <bool P = has_payload, std::enable_if_t<P, int> = 0>
+    void push(const key_type key, payload_slot payload) {
+        const radix_type x = traits::encode(key);
+        assert(x >= last && "radix heap keys must be monotone");
+        const int b = bucket_of(x, last);
+        keys[b].push_back(x);
+        payloads[b].push_back(std::move(payload));
+        total_num++;
+    }
+
+    key_type top(void) const {
+        assert(!empty());
+        ensure_top();
+        return traits::decode(keys[0].back());
+    }
+
+    template <bool P = has_payload, std::enable_if_t<P, int> = 0>
+    const payload_slot& top_payload(void) const {
+        assert(!empty());
+        ensure_top();
+        return payloads[0].back();
+    }
+
+    void pop(void) {
+        assert(!empty());
+        ensure_top();
+        keys[0].pop_back();
+        if constexpr (has_payload)
+            payloads[0].pop_back();
+        total_num--;
+    }
+
+};
+
+
+#endif //RADIX_HEAP_PRIQUEUE
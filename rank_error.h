@@ -0,0 +1,100 @@
+#ifndef RANK_ERROR_H
+#define RANK_ERROR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// rank error of a concurrent priority queue run.
+//
+// Every thread logs its pushes and pops with a timestamp (the invariant TSC
+// on x86, steady_clock elsewhere). Afterwards all logs are merged by time
+// and replayed against a Fenwick tree over the key range: the rank error of
+// a pop is the number of smaller keys present in the queue at that moment,
+// so a strict queue scores 0 up to timestamp skew between threads.
+namespace rank_error {
+
+inline uint64_t timestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct event {
+    uint64_t t;
+    uint32_t key;
+    bool pop;
+};
+
+struct summary {
+    uint64_t pops = 0;
+    double mean = 0.0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+};
+
+// keys must be unique and in [0, key_range)
+inline summary replay(const std::vector<std::vector<event>> & logs, size_t key_range) {
+    std::vector<event> all;
+    size_t total = 0;
+    for (const auto & l : logs)
+        total += l.size();
+    all.reserve(total);
+    for (const auto & l : logs)
+        all.insert(all.end(), l.begin(), l.end());
+    // on equal timestamps the push goes first
+    std::sort(all.begin(), all.end(), [](const event & a, const event & b) {
+        return a.t != b.t ? a.t < b.t : (!a.pop && b.pop);
+    });
+
+    std::vector<uint32_t> fenwick(key_range + 1, 0);
+    auto add = [&](size_t k, int d) {
+        for (size_t i = k + 1; i <= key_range; i += i & (~i + 1))
+            fenwick[i] += d;
+    };
+    auto smaller = [&](size_t k) { // present keys < k
+        uint64_t c = 0;
+        for (size_t i = k; i > 0; i -= i & (~i + 1))
+            c += fenwick[i];
+        return c;
+    };
+
+    std::vector<uint64_t> ranks;
+    ranks.reserve(total / 2);
+    for (const auto & e : all) {
+        if (e.pop) {
+            ranks.push_back(smaller(e.key));
+            add(e.key, -1);
+        } else {
+            add(e.key, +1);
+        }
+    }
+
+    summary s;
+    s.pops = ranks.size();
+    if (ranks.empty())
+        return s;
+    uint64_t sum = 0;
+    for (const auto r : ranks) {
+        sum += r;
+        s.max = std::max(s.max, r);
+    }
+    s.mean = static_cast<double>(sum) / ranks.size();
+    auto p = ranks.begin() + (ranks.size() - 1) * 99 / 100;
+    std::nth_element(ranks.begin(), p, ranks.end());
+    s.p99 = *p;
+    return s;
+}
+
+} // namespace rank_error
+
+#endif // RANK_ERROR_H
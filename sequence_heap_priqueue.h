@@ -0,0 +1,220 @@
+#ifndef SEQUENCE_HEAP_PRIQUEUE
+#define SEQUENCE_HEAP_PRIQUEUE
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+// cache sizes the sequence heap is tuned for (bytes)
+#ifndef SEQHEAP_L1_BYTES
+#define SEQHEAP_L1_BYTES 32768
+#endif
+
+#ifndef SEQHEAP_L2_BYTES
+#define SEQHEAP_L2_BYTES 1048576
+#endif
+
+// sequence heap after Sanders, "Fast Priority Queues for Cached Memory".
+//
+// - new elements go into a small binary insertion heap that lives in L1;
+// - when it fills up it is sorted into a run, which enters merge group 0;
+// - a group holding k runs is k-way merged into one run of the next group,
+//   so group g holds runs of about m*k^g elements and every element is
+//   merged O(log_k(n/m)) times, always by sequential scans;
+// - a sorted deletion buffer caches the smallest elements of all runs, so
+//   pop is either an insertion-heap pop or a buffer head increment.
+//
+// Invariant: every element of the deletion buffer is <= every element of
+// every run. The insertion heap is independent of both.
+template <typename T,
+          size_t L1Bytes = SEQHEAP_L1_BYTES,
+          size_t L2Bytes = SEQHEAP_L2_BYTES>
+class sequence_heap_priqueue {
+
+private:
+    typedef T key_type;
+
+    // insertion heap and deletion buffer each take half of L1
+    static constexpr size_t ins_capacity = std::max<size_t>(16, L1Bytes / 2 / sizeof(T));
+    static constexpr size_t del_capacity = ins_capacity;
+    // merge fan-in: k runs' merge fronts (one run chunk each) fit in L2
+    static constexpr size_t merge_arity = std::clamp<size_t>(L2Bytes / (2 * ins_capacity * sizeof(T)), 4, 128);
+
+    struct run {
+        std::vector<T> data;
+        size_t head = 0;
+
+        bool empty() const { return head == data.size(); }
+        const T & front() const { return data[head]; }
+    };
+
+    typedef std::vector<run> group;
+
+    std::vector<T> ins_heap;   // min-heap through std::greater
+    std::vector<T> del_buf;    // sorted, consumed from del_head
+    size_t del_head = 0;
+    std::vector<group> groups;
+    size_t run_elems = 0;      // elements in all runs (excluding del_buf)
+    size_t total_num = 0;
+
+    struct head {
+        T key;
+        run * r;
+    };
+
+    // scratch reused by merges
+    std::vector<T> merge_out;
+    std::vector<run*> merge_src;
+    std::vector<head> merge_heads;
+
+    bool del_empty() const {
+        return del_head == del_buf.size();
+    }
+
+    // k-way merge of the fronts of `src` into `out`, at most `limit` elements
+    void merge_into(std::vector<run*> & src, std::vector<T> & out, size_t limit) {
+        // tournament over the run heads: a binary min-heap that caches each
+        // head key next to its run, so sifting never dereferences a run
+        merge_heads.clear();
+        for (run * r : src)
+            if (!r->empty())
+                merge_heads.push_back(head{r->front(), r});
+
+        auto later = [](const head & a, const head & b) { return b.key < a.key; };
+        std::make_heap(merge_heads.begin(), merge_heads.end(), later);
+
+        while (limit > 0 && !merge_heads.empty()) {
+            std::pop_heap(merge_heads.begin(), merge_heads.end(), later);
+            head & h = merge_heads.back();
+            out.push_back(h.key);
+            limit--;
+            if (++h.r->head == h.r->data.size()) {
+                merge_heads.pop_back();
+            } else {
+                h.key = h.r->front();
+                std::push_heap(merge_heads.begin(), merge_heads.end(), later);
+            }
+        }
+    }
+
+    // drop exhausted runs so later merges do not scan them
+    void compact_groups() {
+        for (auto & g : groups)
+            g.erase(std::remove_if(g.begin(), g.end(), [](const run & r) { return r.empty(); }), g.end());
+    }
+
+    // refill the deletion buffer with the smallest elements of all runs
+    void refill() {
+        assert(del_empty());
+        del_buf.clear();
+        del_head = 0;
+        if (run_elems == 0)
+            return;
+
+        merge_src.clear();
+        for (auto & g : groups)
+            for (auto & r : g)
+                merge_src.push_back(&r);
+        merge_into(merge_src, del_buf, del_capacity);
+        run_elems -= del_buf.size();
+        compact_groups();
+    }
+
+    // put a sorted run into group `gi`, merging full groups upwards
+    void add_run(run && r, size_t gi) {
+        if (gi == groups.size())
+            groups.emplace_back();
+        groups[gi].push_back(std::move(r));
+        if (groups[gi].size() < merge_arity)
+            return;
+
+        merge_src.clear();
+        size_t n = 0;
+        for (auto & x : groups[gi]) {
+            merge_src.push_back(&x);
+            n += x.data.size() - x.head;
+        }
+        run merged;
+        merged.data.reserve(n);
+        merge_into(merge_src, merged.data, n);
+        groups[gi].clear();
+        add_run(std::move(merged), gi + 1);
+    }
+
+    // sort the full insertion heap into a new run of group 0
+    void flush_insertion_heap() {
+        run r;
+        r.data.swap(ins_heap);
+        std::sort(r.data.begin(), r.data.end());
+        ins_heap.reserve(ins_capacity);
+
+        // keep the invariant: the buffer keeps its size but takes the
+        // smallest elements of (buffer + run); the rest becomes the run
+        if (!del_empty() && r.data.front() < del_buf.back()) {
+            const size_t keep = del_buf.size() - del_head;
+            merge_out.clear();
+            merge_out.reserve(keep + r.data.size());
+            std::merge(del_buf.begin() + del_head, del_buf.end(), r.data.begin(), r.data.end(),
+                       std::back_inserter(merge_out));
+            del_buf.assign(merge_out.begin(), merge_out.begin() + keep);
+            del_head = 0;
+            r.data.assign(merge_out.begin() + keep, merge_out.end());
+        }
+
+        run_elems += r.data.size();
+        add_run(std::move(r), 0);
+
+        if (del_empty())
+            refill();
+    }
+
+public:
+
+    sequence_heap_priqueue() {
+        ins_heap.reserve(ins_capacity);
+        del_buf.reserve(del_capacity);
+    }
+
+    size_t size(void) const {
+        return total_num;
+    }
+
+    bool empty(void) const {
+        return total_num == 0;
+    }
+
+    void push(const key_type key) {
+        if (ins_heap.size() == ins_capacity)
+            flush_insertion_heap();
+        ins_heap.push_back(key);
+        std::push_heap(ins_heap.begin(), ins_heap.end(), std::greater<T>());
+        total_num++;
+    }
+
+    void pop(void) {
+        assert(!empty());
+        if (!ins_heap.empty() && (del_empty() || ins_heap.front() < del_buf[del_head])) {
+            std::pop_heap(ins_heap.begin(), ins_heap.end(), std::greater<T>());
+            ins_heap.pop_back();
+        } else {
+            del_head++;
+            if (del_empty())
+                refill();
+        }
+        total_num--;
+    }
+
+    const T& top(void) const {
+        assert(!empty());
+        if (!ins_heap.empty() && (del_empty() || ins_heap.front() < del_buf[del_head]))
+            return ins_heap.front();
+        return del_buf[del_head];
+    }
+
+};
+
+
+#endif //SEQUENCE_HEAP_PRIQUEUE
@@ -2,25 +2,51 @@
 #define SKIPLIST_PRIQUEUE
 
 #include <bits/stdc++.h>
+#include <memory_resource>
 
 // Class to implement node
+// A node is one allocation: the forward pointers follow the node inline,
+// level + 1 of them, so a search touches one cache line per visited node.
+// The key is not const so the first one can be moved out before pop().
 template <typename T>
 class list_node
 {
 public:
-	const T key;
+	T key;
 	const int level;
-	list_node<T> **forward;
+	list_node<T> *forward[1];
 
-	list_node(const T key, int level) : key(key), level(level)
+	// bytes of a node with level + 1 forward pointers
+	static size_t bytes(int level)
 	{
-		// Allocate memory to forward
-		forward = new list_node<T> *[level + 1];
-		memset(forward, 0, sizeof(list_node<T> *) * (level + 1));
+		return sizeof(list_node<T>) + sizeof(list_node<T> *) * level;
+	}
+
+	// allocate a node with level + 1 forward pointers, all null
+	static list_node<T> *create(T key, int level, std::pmr::memory_resource *mr)
+	{
+		void *mem = mr->allocate(bytes(level), alignof(list_node<T>));
+		return new (mem) list_node<T>(std::move(key), level);
+	}
+
+	static void destroy(list_node<T> *node, std::pmr::memory_resource *mr)
+	{
+		const int level = node->level;
+		node->~list_node<T>();
+		mr->deallocate(node, bytes(level), alignof(list_node<T>));
+	}
+
+private:
+	list_node(T key, int level) : key(std::move(key)), level(level)
+	{
+		std::fill(forward, forward + level + 1, nullptr);
 	}
 };
 
 // Class for Skip list
+// Duplicate keys are kept: an equal key is inserted after the ones already
+// present, so the first node is always the minimum and is first on every
+// level it has, which lets pop() unlink it without a search.
 template <typename T>
 class skip_list_priqueue
 {
@@ -32,23 +58,33 @@ private:
 	// P is the fraction of the nodes with level
 	// i pointers also having level i+1 pointers
 	const float proportion;
+	// nodes come from here (see node_memory.h)
+	std::pmr::memory_resource *const mr;
 	// current level of skip list
 	int level;
 	// pointer to header node
 	list_node<key_type> *const header;
+	// xorshift64* state of the level generator
+	uint64_t rng = 0x9E3779B97F4A7C15ull;
+	// next pseudo random 64-bit word, never zero
+	uint64_t next_random();
 	// ramdomize the level
 	int random_level();
 	// create node
 	list_node<key_type> *create_node(key_type, int);
 	// insert node
 	void insert(key_type);
-	// erase node
-	void erase(key_type);
+	// unlink and free the first node
+	void erase_first();
 	// total num
 	size_t total_num = 0;
 
 public:
-	skip_list_priqueue(int = 64, float = 0.5);
+	skip_list_priqueue(int = 64, float = 0.5, std::pmr::memory_resource * = std::pmr::get_default_resource());
+	~skip_list_priqueue();
+
+	skip_list_priqueue(const skip_list_priqueue &) = delete;
+	skip_list_priqueue &operator=(const skip_list_priqueue &) = delete;
 
 	size_t size(void) const
 	{
@@ -60,16 +96,17 @@ public:
 		return total_num == 0;
 	}
 
-	void push(const key_type key)
+	// the key is moved into its node, so move-only keys work too
+	void push(key_type key)
 	{
-		insert(key);
+		insert(std::move(key));
 		total_num++;
 	}
 
 	void pop(void)
 	{
 		assert(!empty());
-		erase(header->forward[0]->key);
+		erase_first();
 		total_num--;
 	}
 
@@ -83,19 +120,42 @@ public:
 };
 
 template <typename key_type>
-skip_list_priqueue<key_type>::skip_list_priqueue(int maxlevel, float proportion) : maxlevel(maxlevel), proportion(proportion), level(0), header(new list_node<key_type>({}, maxlevel)){};
+skip_list_priqueue<key_type>::skip_list_priqueue(int maxlevel, float proportion, std::pmr::memory_resource *mr) : maxlevel(maxlevel), proportion(proportion), mr(mr), level(0), header(list_node<key_type>::create({}, maxlevel, mr)){};
+
+template <typename key_type>
+skip_list_priqueue<key_type>::~skip_list_priqueue()
+{
+	list_node<key_type> *node = header;
+	while (node != nullptr)
+	{
+		list_node<key_type> *next = node->forward[0];
+		list_node<key_type>::destroy(node, mr);
+		node = next;
+	}
+}
+
+template <typename key_type>
+uint64_t skip_list_priqueue<key_type>::next_random()
+{
+	rng ^= rng >> 12;
+	rng ^= rng << 25;
+	rng ^= rng >> 27;
+	return rng * 0x2545F4914F6CDD1Dull;
+}
 
 // create random level for node
+// geometric with parameter proportion; for the default 0.5 every bit of a
+// random word is one coin flip, so the level is its count of trailing zeros
 template <typename key_type>
 int skip_list_priqueue<key_type>::random_level()
 {
-	float r = (float)rand() / RAND_MAX;
+	if (proportion == 0.5f)
+		return std::min(__builtin_ctzll(next_random()), maxlevel);
+
+	const uint64_t threshold = static_cast<uint64_t>(proportion * 18446744073709551616.0);
 	int lvl = 0;
-	while (r < proportion && lvl < maxlevel)
-	{
+	while (lvl < maxlevel && next_random() < threshold)
 		lvl++;
-		r = (float)rand() / RAND_MAX;
-	}
 	return lvl;
 };
 
@@ -103,8 +163,7 @@ int skip_list_priqueue<key_type>::random_level()
 template <typename key_type>
 list_node<key_type> *skip_list_priqueue<key_type>::create_node(key_type key, int level)
 {
-	list_node<key_type> *node = new list_node<key_type>(key, level);
-	return node;
+	return list_node<key_type>::create(std::move(key), level, mr);
 };
 
 // insert key
@@ -114,80 +173,53 @@ void skip_list_priqueue<key_type>::insert(key_type key)
 	list_node<key_type> *current = header;
 
 	list_node<key_type> *update[maxlevel + 1];
-	memset(update, 0, sizeof(list_node<key_type> *) * (maxlevel + 1));
 
-#pragma omp parallel for
+	// stop in front of the first larger key, i.e. behind any equal ones
 	for (int i = level; i >= 0; i--)
 	{
-		while (current->forward[i] != nullptr && current->forward[i]->key < key)
+		while (current->forward[i] != nullptr && !(key < current->forward[i]->key))
 		{
 			current = current->forward[i];
 		}
 		update[i] = current; // set the correct node to update
 	}
 
-	current = current->forward[0];
+	int rlevel = random_level();
 
-	if (current == nullptr || current->key != key)
+	if (rlevel > level)
 	{
-
-		int rlevel = random_level();
-
-		if (rlevel > level)
+		for (int i = level + 1; i < rlevel + 1; i++)
 		{
-			for (int i = level + 1; i < rlevel + 1; i++)
-			{
-				update[i] = header; // set up new levels
-			}
-			level = rlevel; // Update the list current level
+			update[i] = header; // set up new levels
 		}
+		level = rlevel; // Update the list current level
+	}
 
-		list_node<key_type> *node = create_node(key, rlevel);
+	list_node<key_type> *node = create_node(std::move(key), rlevel);
 
-#pragma omp parallel for
-		for (int i = 0; i <= rlevel; i++)
-		{
-			node->forward[i] = update[i]->forward[i];
-			update[i]->forward[i] = node;
-		}
+	for (int i = 0; i <= rlevel; i++)
+	{
+		node->forward[i] = update[i]->forward[i];
+		update[i]->forward[i] = node;
 	}
 };
 
+// the first node is the successor of the header on each of its levels
 template <typename key_type>
-void skip_list_priqueue<key_type>::erase(key_type key)
+void skip_list_priqueue<key_type>::erase_first()
 {
-	list_node<key_type> *current = header;
-	list_node<key_type> *update[maxlevel + 1];
-	memset(update, 0, sizeof(list_node<key_type> *) * (maxlevel + 1));
+	list_node<key_type> *first = header->forward[0];
 
-#pragma omp parallel for
-	for (int i = level; i >= 0; i--)
+	for (int i = 0; i <= first->level; i++)
 	{
-		while (current->forward[i] != nullptr && current->forward[i]->key < key)
-			current = current->forward[i];
-		update[i] = current;
+		header->forward[i] = first->forward[i];
 	}
 
-	current = current->forward[0];
-
-	if (current != nullptr && current->key == key)
+	while (level > 0 && header->forward[level] == nullptr)
 	{
-
-#pragma omp parallel for
-		for (int i = 0; i <= level; i++)
-		{
-			if (update[i]->forward[i] != current)
-				break;
-
-			update[i]->forward[i] = current->forward[i];
-		}
-
-		while (level > 0 && header->forward[level] == nullptr)
-		{
-			level--;
-		}
-		delete current;
+		level--;
 	}
+	list_node<key_type>::destroy(first, mr);
 }
 
 // Display list
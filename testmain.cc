@@ -5,10 +5,19 @@
 #include <cstdint>
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <random>
 #include <queue>
+#include <string>
 #include <vector>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 // Intel VTune ITT markers
 #ifdef USE_ITT
 #include <ittnotify.h>
@@ -25,219 +34,1902 @@ inline void itt_resume() {}
 inline void itt_pause() {}
 #endif
 
+// hardware counters around the same region (perf=1, Linux perf_event_open)
+#if defined(TPERF)
+#include "perf_counters.h"
+static perf_counters::group_set & perf_groups() {
+    static perf_counters::group_set groups;
+    return groups;
+}
+#endif
+
+// the timed region of every workload: ITT task markers plus the counters
+inline void timed_region_begin() {
+    itt_task_begin();
+#if defined(TPERF)
+    perf_groups().start();
+#endif
+}
+inline void timed_region_end() {
+#if defined(TPERF)
+    perf_groups().stop();
+#endif
+    itt_task_end();
+}
+
+// per-op latencies (latency=1): every queue call of the sequential timed
+// regions is timed on its own with the serialized cycle counter and recorded
+// per op type; elapsed_time_us then includes the timer cost
+#if defined(TLATENCY)
+#include "latency_histogram.h"
+#define TIMED_OP(hist, ...) do { const uint64_t t0_ = latency::start(); __VA_ARGS__; (hist).record(latency::stop() - t0_); } while (0)
+#else
+#define TIMED_OP(hist, ...) __VA_ARGS__
+#endif
+
 // include for test type II
 #include "graph.h"
+#include "graph_gen.h"
+#include "graph_cache.h"
+#include "delta_stepping.h"
 
 // include the priority queues
 #include "boost/heap/priority_queue.hpp"
 #include "boost/heap/pairing_heap.hpp"
+#include "node_memory.h"
 #include "pairing_heap_priqueue.h"
 #include "skiplist_priqueue.h"
 #include "arch_aware_heap.h"
+#include "radix_heap_priqueue.h"
+#include "sequence_heap_priqueue.h"
+#include "multiqueue_priqueue.h"
+#include "lockfree_skiplist_priqueue.h"
+#include "rank_error.h"
+#include "bench_record.h"
+#include "bench_stats.h"
+#if defined(TMEMTRACK)
+// replaces the global operator new/delete of this binary with counting ones
+#define MEM_TRACKING_DEFINE_OPERATORS
+#endif
+#include "mem_tracking.h"
+#include "op_trace.h"
+#include "hold_model.h"
+#include "des_workload.h"
 
 #define _STR(x) #x
 #define STR(x) _STR(x)
 #define MAX_BATCH_SIZE 1000
 
-#ifndef TCAND
-#define TCAND A
-#define TCAND_A
+// The binary holds every candidate and workload; candidate, workload,
+// size, seed and repetitions are picked on the command line (see usage()).
+// The build-time knobs below select *variants* of the workloads and apply to
+// every run of the binary.
+
+// backing memory of the arch-aware heap (E): fixed (default), reserve, thp, hugetlb
+#ifndef TMEM
+#define TMEM fixed
+#define TMEM_fixed
 #endif
 
-#ifndef TTYPE
-#define TTYPE I
-#define TTYPE_I
+// TEST II frontier handling: lazy (push duplicates, default), dk (decrease-key)
+// or delta (parallel delta-stepping; does not use the candidate queue)
+#ifndef TDIJ
+#define TDIJ lazy
+#define TDIJ_lazy
 #endif
 
-#ifndef TID
-#define TID i
-#define TID_i
+// node memory of the node-based candidates B, C and D: new (default), slab,
+// arena or pool (see node_memory.h)
+#ifndef TALLOC
+#define TALLOC new
+#define TALLOC_new
 #endif
 
-enum TEST_CAND
-{
-    A,B,C,D,E
-};
+// threads for TEST II graph generation (default: all hardware threads)
+#ifndef TGEN_THREADS
+#define TGEN_THREADS par::default_threads()
+#endif
+
+// directory of the TEST II graph cache, "off" disables it
+#ifndef TGRAPH_CACHE
+#define TGRAPH_CACHE "graph_cache"
+#endif
+
+// delta-stepping threads (default: all hardware threads) and bucket width
+// (default: 0, derived from the graph)
+#ifndef TSSSP_THREADS
+#define TSSSP_THREADS par::default_threads()
+#endif
+#ifndef TDELTA
+#define TDELTA 0.0
+#endif
+
+// key width of the radix heap (F): 32 (integer distances, default) or 64 (double distances)
+#if defined(TRADIX_64)
+#define TRADIX_KEY double
+#else
+#define TRADIX_KEY uint32_t
+#endif
+
+// TEST I batches: one element at a time (default) or through push_bulk/pop_n (batch=1)
+#if defined(TBATCH)
+#define TBATCH_API "bulk"
+#else
+#define TBATCH_API "single"
+#endif
+
+// multi-threaded TEST I: mt=P threads share one queue (H and I natively, the
+// others behind a mutex); mt_split=1 makes half of them pure producers and
+// the other half pure consumers; mq_c=c gives the MultiQueue c*P shards
+#if defined(TMT_THREADS)
+#define TMQ_THREADS TMT_THREADS
+#else
+#define TMQ_THREADS 1
+#endif
+#ifndef TMQ_C
+#define TMQ_C 2
+#endif
+
+#if defined(TMEM_reserve)
+#define TMEM_PAGES heap_pages::small
+#elif defined(TMEM_thp)
+#define TMEM_PAGES heap_pages::transparent
+#elif defined(TMEM_hugetlb)
+#define TMEM_PAGES heap_pages::explicit_2m
+#endif
 
 enum TEST_ID
 {
     i,ii,iii,iv,v,vi
 };
 
+static const char * const test_id_names[] = {"i","ii","iii","iv","v","vi"};
+
 using namespace std;
 
+//// candidates
+// every candidate names its TEST I (int keys) and TEST II (NODE_M) queue and
+// how to build one for N elements; `void` marks a workload it cannot run,
+// together with the reason reported for the skipped cell. TEST III (hold
+// model, int keys) uses the TEST I queue unless a candidate names another
+// one with its own make_III. TEST IV (events with records, des_workload.h)
+// needs a queue template over the event type; skip_IV_move names candidates
+// whose queue copies values and so cannot hold move-only events. TEST V
+// (top-k of a stream) bounds the TEST I queue at k keys unless a candidate
+// names another one with its own make_V
+
+template <typename QI, typename QII>
+struct default_candidate {
+    using queue_I = QI;
+    using queue_II = QII;
+    using queue_III = QI;
+    template <typename Ev>
+    using queue_IV = void;
+    using queue_V = QI;
+    static constexpr const char * skip_I = "";
+    static constexpr const char * skip_II = "";
+    static constexpr const char * skip_III = "";
+    static constexpr const char * skip_IV = "";
+    static constexpr const char * skip_IV_move = "";
+    static constexpr const char * skip_V = "";
+    static unique_ptr<QI> make_I(size_t) { return make_unique<QI>(); }
+    static unique_ptr<QII> make_II(size_t) { return make_unique<QII>(); }
+};
+
+// B and C keep one handle per node in decrease-key mode
+template <typename PQ>
+#if defined(TDIJ_dk)
+using dk_or_lazy = node_handle_queue<PQ>;
+#else
+using dk_or_lazy = PQ;
+#endif
+
+template <typename PQ>
+unique_ptr<PQ> make_node_queue(size_t N) {
+#if defined(TDIJ_dk)
+    return make_unique<PQ>(N);
+#else
+    (void)N;
+    return make_unique<PQ>();
+#endif
+}
+
+// TEST II queue of a candidate without decrease-key support
+#if defined(TDIJ_dk)
+#define TDK_SKIP "decrease-key mode (dij=dk) is only implemented for candidates B, C and E"
+#define TDK_QUEUE(...) void
+#else
+#define TDK_SKIP ""
+#define TDK_QUEUE(...) __VA_ARGS__
+#endif
+
+template <typename T>
+using boost_pairing_heap = boost::heap::pairing_heap<T,boost::heap::compare<compare_item<T>>,boost::heap::allocator<std::pmr::polymorphic_allocator<T>>>;
+
+struct cand_A : default_candidate<std::priority_queue<int,vector<int>,greater<int>>,
+                                  TDK_QUEUE(std::priority_queue<NODE_M,vector<NODE_M>,greater<NODE_M>>)> {
+    static constexpr const char * skip_II = TDK_SKIP;
+    template <typename Ev>
+    using queue_IV = std::priority_queue<Ev,vector<Ev>,greater<Ev>>;
+};
+
+struct cand_B : default_candidate<boost_pairing_heap<int>, dk_or_lazy<boost_pairing_heap<NODE_M>>> {
+    static unique_ptr<queue_II> make_II(size_t N) { return make_node_queue<queue_II>(N); }
+    template <typename Ev>
+    using queue_IV = boost_pairing_heap<Ev>;
+};
+
+struct cand_C : default_candidate<pairing_heap_priqueue<int>, dk_or_lazy<pairing_heap_priqueue<NODE_M>>> {
+    static unique_ptr<queue_II> make_II(size_t N) { return make_node_queue<queue_II>(N); }
+    template <typename Ev>
+    using queue_IV = pairing_heap_priqueue<Ev>;
+};
+
+struct cand_D : default_candidate<skip_list_priqueue<int>, TDK_QUEUE(skip_list_priqueue<NODE_M>)> {
+    static constexpr const char * skip_II = TDK_SKIP;
+    template <typename Ev>
+    using queue_IV = skip_list_priqueue<Ev>;
+};
+
+#if defined(TDIJ_dk)
+using cand_E_queue_II = IndexedMinHeap;
+#else
+using cand_E_queue_II = node_m_queue<MinHeapT<NHPQ_MINHEAP_ARITY,double,int>>;
+#endif
+
+struct cand_E : default_candidate<MinHeap, cand_E_queue_II> {
+    static unique_ptr<queue_I> make_I(size_t N) {
+#if defined(TMEM_PAGES)
+        // growable heap: reserves address space, so N need not be known up front
+        (void)N;
+        return make_unique<queue_I>(heap_growable, queue_I::default_reserve, TMEM_PAGES);
+#else
+        return make_unique<queue_I>(queue_I::minDepthForSize(static_cast<uint32_t>(N)));
+#endif
+    }
+    static unique_ptr<queue_II> make_II(size_t N) {
+#if defined(TDIJ_dk)
+        // one entry per node at most
+        return make_unique<queue_II>(static_cast<uint32_t>(N));
+#elif defined(TMEM_PAGES)
+        (void)N;
+        return make_unique<queue_II>(heap_growable, queue_II::default_reserve, TMEM_PAGES);
+#else
+        // lazy deletion pushes at most once per relaxed edge (2 directions per edge)
+        return make_unique<queue_II>(queue_II::minDepthForSize(static_cast<uint32_t>(4*N+1)));
+#endif
+    }
+    // time keys in the key array, the event bodies in the payload array
+    template <typename Ev>
+    using queue_IV = des::keyed_event_queue<MinHeapT<NHPQ_MINHEAP_ARITY,int,typename Ev::body_type>, Ev>;
+    template <typename Ev>
+    static unique_ptr<queue_IV<Ev>> make_IV(size_t N) {
+#if defined(TMEM_PAGES)
+        (void)N;
+        return make_unique<queue_IV<Ev>>(heap_growable, queue_IV<Ev>::default_reserve, TMEM_PAGES);
+#else
+        return make_unique<queue_IV<Ev>>(queue_IV<Ev>::minDepthForSize(static_cast<uint32_t>(N)));
+#endif
+    }
+    // fixed capacity k, the root is the threshold
+    using queue_V = TopKHeap;
+    static unique_ptr<queue_V> make_V(size_t k) { return make_unique<queue_V>(static_cast<uint32_t>(k)); }
+};
+
+struct cand_F : default_candidate<void, TDK_QUEUE(node_m_queue<radix_heap<TRADIX_KEY,int>>)> {
+    static constexpr const char * skip_I = "radix heap needs monotone keys: only TEST II (Dijkstra), III (hold), IV (events) and V (top-k) are supported";
+    static constexpr const char * skip_II = TDK_SKIP;
+    // a hold pushes the popped key plus a non-negative increment: monotone
+    using queue_III = radix_heap<int>;
+    static unique_ptr<queue_III> make_III(size_t) { return make_unique<queue_III>(); }
+    // top-k only pushes keys above the popped threshold: monotone as well
+    using queue_V = radix_heap<int>;
+    static unique_ptr<queue_V> make_V(size_t) { return make_unique<queue_V>(); }
+    template <typename Ev>
+    using queue_IV = des::keyed_event_queue<radix_heap<int,typename Ev::body_type>, Ev>;
+};
+
+struct cand_G : default_candidate<sequence_heap_priqueue<int>, TDK_QUEUE(sequence_heap_priqueue<NODE_M>)> {
+    static constexpr const char * skip_II = TDK_SKIP;
+    template <typename Ev>
+    using queue_IV = sequence_heap_priqueue<Ev>;
+    static constexpr const char * skip_IV_move = "sequence heap merges copy their runs: store=move is not supported";
+};
 
-#if defined(TTYPE_I)
-typedef int value_type;
-#elif defined(TTYPE_II)
-typedef NODE_M value_type;
+#if defined(TMT_THREADS)
+using cand_H_queue_I = multiqueue_priqueue<int>;
+using cand_I_queue_I = lockfree_skiplist_priqueue<int>;
+#else
+using cand_H_queue_I = multiqueue_seq_priqueue<int>;
+using cand_I_queue_I = lockfree_skiplist_seq_priqueue<int>;
 #endif
 
-#if defined(TCAND_A)
-using chosen_pri_queue = std::priority_queue<value_type,vector<value_type>,greater<value_type>>;
-#elif defined(TCAND_B)
-using chosen_pri_queue = boost::heap::pairing_heap<value_type,boost::heap::compare<compare_item<value_type>>>;
-#elif defined(TCAND_C)
-using chosen_pri_queue = pairing_heap_priqueue<value_type>;
-#elif defined(TCAND_D)
-using chosen_pri_queue = skip_list_priqueue<value_type>;
-#elif defined(TCAND_E)
-#if !defined(TTYPE_I)
-#error "Arch-aware heap only supports TTYPE_I (int)"
+struct cand_H : default_candidate<cand_H_queue_I, void> {
+    static constexpr const char * skip_II = "MultiQueue pops are relaxed: only TEST I and III are supported";
+    static constexpr const char * skip_IV = "MultiQueue shards hold int keys: only TEST I and III are supported";
+    using queue_V = void;
+    static constexpr const char * skip_V = "MultiQueue pops are relaxed: its top is not the k-th largest key";
+    static unique_ptr<queue_I> make_I(size_t N) {
+        // every shard reserves room for all N keys (address space only)
+        return make_unique<queue_I>(TMQ_THREADS, TMQ_C, static_cast<uint32_t>(N));
+    }
+};
+
+struct cand_I : default_candidate<cand_I_queue_I, TDK_QUEUE(lockfree_skiplist_seq_priqueue<NODE_M>)> {
+    static constexpr const char * skip_II = TDK_SKIP;
+    template <typename Ev>
+    using queue_IV = lockfree_skiplist_seq_priqueue<Ev>;
+    static constexpr const char * skip_IV_move = "lock-free nodes are read by concurrent searches and copied out: store=move is not supported";
+};
+
+
+//// memory resource of the node-based candidates (B, C, D) for one run;
+// installed as the default resource, which B reaches through its
+// polymorphic_allocator and C and D through their constructors' default.
+// Created before the queue, so it outlives it.
+struct node_resource_scope {
+#if defined(TALLOC_slab)
+    node_mem::slab_resource res;
+#elif defined(TALLOC_arena)
+    std::pmr::monotonic_buffer_resource res;
+#elif defined(TALLOC_pool)
+    std::pmr::unsynchronized_pool_resource res;
 #endif
-using chosen_pri_queue = MinHeap;
+#if !defined(TALLOC_new)
+    std::pmr::memory_resource * const prev = std::pmr::set_default_resource(&res);
+    ~node_resource_scope() { std::pmr::set_default_resource(prev); }
 #endif
+};
+
+
+// bulk API of the batched TEST I mode; candidates without one
+// (everything but E) take the batch one element at a time
+template <typename PQ, typename = void>
+struct has_bulk_api : std::false_type {};
+
+template <typename PQ>
+struct has_bulk_api<PQ, std::void_t<decltype(std::declval<PQ&>().push_bulk(nullptr, size_t(0))),
+                                    decltype(std::declval<PQ&>().pop_n(nullptr, size_t(0)))>> : std::true_type {};
+
+template <typename PQ, typename T>
+inline void pq_push_bulk(PQ& pq, const T* src, size_t n) {
+    if constexpr (has_bulk_api<PQ>::value) {
+        pq.push_bulk(src, n);
+    } else {
+        for (size_t k=0;k<n;k++) pq.push(src[k]);
+    }
+}
+
+template <typename PQ, typename T>
+inline size_t pq_pop_n(PQ& pq, T* out, size_t n) {
+    if constexpr (has_bulk_api<PQ>::value) {
+        return pq.pop_n(out, n);
+    } else {
+        size_t k=0;
+        for (;k<n && !pq.empty();k++) {
+            out[k] = pq.top();
+            pq.pop();
+        }
+        return k;
+    }
+}
+
+// thread-safe queues hand out per-thread handles themselves (H, I)
+template <typename PQ, typename = void>
+struct has_handles : std::false_type {};
+
+template <typename PQ>
+struct has_handles<PQ, std::void_t<decltype(std::declval<PQ&>().get_handle())>> : std::true_type {};
+
+// TEST IV: take the earliest event out of the queue, moving it rather than
+// copying. The keyed heaps (E, F) split key and body and rebuild the event;
+// the others hand out a const reference to stored elements that we move
+// from right before pop(). Only the body is moved from, the time stays, so
+// whatever pop() compares is still valid.
+template <typename PQ, typename = void>
+struct has_take_top : std::false_type {};
+
+template <typename PQ>
+struct has_take_top<PQ, std::void_t<decltype(std::declval<PQ&>().take_top())>> : std::true_type {};
+
+template <typename PQ>
+inline auto take_top(PQ& pq) {
+    if constexpr (has_take_top<PQ>::value) {
+        return pq.take_top();
+    } else {
+        using Ev = std::remove_cv_t<std::remove_reference_t<decltype(pq.top())>>;
+        Ev ev = std::move(const_cast<Ev&>(pq.top()));
+        pq.pop();
+        return ev;
+    }
+}
+
+// boost's heaps only move through emplace()
+template <typename PQ, typename Ev, typename = void>
+struct has_emplace : std::false_type {};
+
+template <typename PQ, typename Ev>
+struct has_emplace<PQ, Ev, std::void_t<decltype(std::declval<PQ&>().emplace(std::declval<Ev>()))>> : std::true_type {};
+
+template <typename PQ, typename Ev>
+inline void push_event(PQ& pq, Ev&& ev) {
+    if constexpr (has_emplace<PQ, Ev>::value)
+        pq.emplace(std::move(ev));
+    else
+        pq.push(std::move(ev));
+}
+
+// E sizes its arrays up front; the other queues start empty
+template <typename Cand, typename Ev, typename = void>
+struct has_make_IV : std::false_type {};
+
+template <typename Cand, typename Ev>
+struct has_make_IV<Cand, Ev, std::void_t<decltype(Cand::template make_IV<Ev>(size_t(0)))>> : std::true_type {};
+
+template <typename Cand, typename Ev>
+unique_ptr<typename Cand::template queue_IV<Ev>> make_event_queue(size_t N) {
+    if constexpr (has_make_IV<Cand, Ev>::value)
+        return Cand::template make_IV<Ev>(N);
+    else
+        return make_unique<typename Cand::template queue_IV<Ev>>();
+}
 
 
+//// command line
+struct bench_config {
+    string cand;
+    string type;
+    string id;       // set when the size came from --id
+    size_t size;
+    uint64_t seed;
+    unsigned rep;
+    const op_trace::trace * trace; // type "trace": the replayed op stream ...
+    string trace_file;             // ... and its file
+    string cpus;                   // CPUs the process is pinned to (empty: not pinned)
+    string dist;                   // types III, IV: increment distribution ...
+    string fill;                   // ... and fill order (hold_model.h)
+    size_t payload;                // type IV: record bytes per event ...
+    string store;                  // ... and where records live (des_workload.h)
+    size_t k;                      // type V: keys kept of the stream
+};
+
 //calculate test size
 const size_t sample_size(TEST_ID id) {
     return pow(10,(3+static_cast<int>(id)));
 }
 
+static void usage(const char * prog) {
+    fprintf(stderr,
+            "usage: %s [--cand A,B,..] [--type I,II,III,IV,V] [--size N,..|--id i..vi,..] [--seed S] [--reps R]\n"
+            "          [--warmup W] [--pin CPU,..] [--dist D,..] [--fill F,..] [--payload B,..] [--store S,..]\n"
+            "          [--k K,..]\n"
+            "       %s --record FILE [--size N|--id i..vi] [--seed S]\n"
+            "       %s --trace FILE [--cand A,B,..] [--reps R]\n"
+            "  --cand  candidates A-I (default A); type V also takes the references\n"
+            "          partial_sort and nth_element\n"
+            "  --type  workloads I (random push/pop), II (Dijkstra), III (hold model),\n"
+            "          IV (event simulation: hold model with event records) and\n"
+            "          V (top-k of a stream of --size keys) (default I)\n"
+            "  --size  element / node counts, any N >= 1, e.g. 1000,1500,2e6 (default: --id i)\n"
+            "  --id    README test ids: i..vi = 1e3..1e8\n"
+            "  --seed  workload seed (default 123)\n"
+            "  --reps  timed repetitions of every cell (default 1); with R >= 2 a summary\n"
+            "          record follows (median, MAD, 95%% bootstrap CI of elapsed_time_us)\n"
+            "  --warmup  untimed runs of every cell before its repetitions (default 0)\n"
+            "  --pin   pin the process (and threads it starts) to these CPUs\n"
+            "  --dist  type III/IV increment distributions: exp, uniform, bimodal, triangular,\n"
+            "          sawtooth (default exp)\n"
+            "  --fill  type III/IV fill orders: random, sorted, reverse (default random)\n"
+            "  --payload  type IV record bytes per event: 8, 32, 64, 128 (default 32)\n"
+            "  --store    type IV record placement: inline, indirect, move (default inline)\n"
+            "  --k     type V keys to keep, 1 <= K <= size, e.g. 10,1e6 (default 1000)\n"
+            "  --record  write the TEST I op stream of one size and seed to FILE (see op_trace.h)\n"
+            "  --trace   replay the op stream in FILE on every candidate (type \"trace\")\n"
+            "one JSON object per cell and repetition is printed to stdout\n", prog, prog, prog);
+}
 
-int main()
-{
-    //// test preparation
-    srand(123);
+static vector<string> split_list(const string & s) {
+    vector<string> out;
+    size_t b = 0;
+    while (b <= s.size()) {
+        const size_t e = std::min(s.find(',', b), s.size());
+        if (e > b)
+            out.push_back(s.substr(b, e - b));
+        b = e + 1;
+    }
+    return out;
+}
+
+
+//// counters of the last timed region (perf=1), as totals and per queue
+// operation (push, pop, top or decrease-key) of the counted thread
+static void report_perf(bench_record & rec, uint64_t ops) {
+#if defined(TPERF)
+    const perf_counters::group_set & groups = perf_groups();
+    const vector<perf_counters::reading> counts = groups.read();
+    rec.add("perf", counts.empty() ? "unavailable" : "on");
+    rec.add("perf_scope", "calling thread"); // mt and delta workers other than 0 are not counted
+    if (!groups.missing().empty())
+        rec.add("perf_missing", groups.missing());
+    uint64_t cycles = 0, instructions = 0;
+    double running = 1.0;
+    for (const auto & c : counts) {
+        rec.add(c.name, c.value);
+        rec.add((string(c.name) + "_per_op").c_str(), static_cast<double>(c.value) / std::max<uint64_t>(ops, 1));
+        if (!strcmp(c.name, "cycles")) cycles = c.value;
+        if (!strcmp(c.name, "instructions")) instructions = c.value;
+        running = std::min(running, c.running);
+    }
+    if (cycles && instructions)
+        rec.add("ipc", static_cast<double>(instructions) / cycles);
+    if (running < 1.0)
+        rec.add("perf_running", running); // groups were multiplexed, counts are scaled
+#else
+    (void)rec; (void)ops;
+#endif
+}
+
+
+// memory of the queue since `before` (taken once the inputs exist), while
+// it still holds whatever it keeps after draining. The resident set is always
+// reported; allocation counts need memtrack=1. RSS growth is not divided per
+// element: it depends on the pages malloc already held from earlier cells
+static void report_memory(bench_record & rec, const mem_tracking::snapshot & before, uint64_t max_elements) {
+    rec.add("max_elements", max_elements);
+    uint64_t rss_kb = 0, hwm_kb = 0;
+    if (before.rss && mem_tracking::read_rss(rss_kb, hwm_kb)) {
+        rec.add("peak_rss_kb", hwm_kb);
+        if (before.rss_peak_reset) {
+            // mmap'ed storage (E with mem=reserve|huge) only shows up here
+            const uint64_t growth_kb = hwm_kb > before.rss_kb ? hwm_kb - before.rss_kb : 0;
+            rec.add("rss_growth_kb", growth_kb);
+        }
+    }
+#if defined(TMEMTRACK)
+    const mem_tracking::usage u = mem_tracking::since(before);
+    rec.add("allocs", u.allocs);
+    rec.add("frees", u.frees);
+    rec.add("queue_peak_bytes", u.peak_bytes);
+    rec.add("retained_bytes", u.retained_bytes);
+    rec.add("bytes_per_element", static_cast<double>(u.peak_bytes) / std::max<uint64_t>(max_elements, 1));
+#endif
+}
+
+
+#if defined(TLATENCY)
+struct op_latency {
+    latency::histogram push, pop, top, decrease_key;
+
+    static void report(bench_record & rec, const char * op, const latency::histogram & h) {
+        if (h.count() == 0)
+            return;
+        const double tpn = latency::ticks_per_ns();
+        const string p = op;
+        rec.add((p + "_count").c_str(), h.count());
+        rec.add((p + "_mean_ns").c_str(), h.mean() / tpn);
+        rec.add((p + "_p50_ns").c_str(), h.quantile(0.5) / tpn);
+        rec.add((p + "_p90_ns").c_str(), h.quantile(0.9) / tpn);
+        rec.add((p + "_p99_ns").c_str(), h.quantile(0.99) / tpn);
+        rec.add((p + "_p999_ns").c_str(), h.quantile(0.999) / tpn);
+        rec.add((p + "_max_ns").c_str(), h.max() / tpn);
+    }
+
+    // percentiles in ns; values include timer_overhead_ns
+    void report(bench_record & rec) const {
+        rec.add("timer_overhead_ns", latency::overhead_ticks() / latency::ticks_per_ns());
+        report(rec, "push", push);
+        report(rec, "pop", pop);
+        report(rec, "top", top);
+        report(rec, "decrease_key", decrease_key);
+    }
+};
+#endif
 
-    printf("[TEST] {\"cand\": [\"%s\"], \"type\": [\"%s\"], \"id\": [\"%s\"]}\n", STR(TCAND), STR(TTYPE), STR(TID));
 
-    const size_t N = sample_size(TID);
-    bool skip_test = false;
-#if defined(TCAND_E)
-    const int depth = MinHeap::minDepthForSize(static_cast<uint32_t>(N));
-    chosen_pri_queue pq(depth);
+//// TEST I: random add and pop elements
+
+// the TEST I op stream: keys 0..N-1 shuffled with mt19937(seed), pushed in
+// random batches, each followed by a random pop batch. Batch sizes come from
+// their own generator and the live element count, never from the queue, so
+// the stream only depends on (N, seed) and --record writes exactly what
+// run_I executes.
+struct test_I_stream {
+    vector<int> keys;
+    std::mt19937 batch_rng;
+
+    test_I_stream(size_t N, uint64_t seed) : keys(N), batch_rng(seed ^ 0x9E3779B97F4A7C15ull) {
+        for (size_t i=0;i<N;i++) keys[i]=i;
+        std::mt19937 g(seed);
+        std::shuffle(keys.begin(), keys.end(), g);
+    }
+
+    // 1..bound
+    uint32_t batch(uint32_t bound) {
+        return 1 + batch_rng() % bound;
+    }
+};
+
+static op_trace::writer record_I(size_t N, uint64_t seed) {
+    test_I_stream s(N, seed);
+    op_trace::writer w;
+    w.reserve(2*N, N);
+    uint32_t total_cnt = N;
+    while (total_cnt!=0 || w.size()!=0) {
+        if (total_cnt>0) {
+            const uint32_t push_batch_size = s.batch(total_cnt);
+            for (uint32_t n=0;n<push_batch_size;n++)
+                w.push(s.keys[--total_cnt]);
+        }
+        const uint32_t pop_batch_size = s.batch(w.size());
+        for (uint32_t n=0;n<pop_batch_size;n++)
+            w.pop();
+    }
+    return w;
+}
+
+// mt=P: every thread pushes its share of the keys and pops in random batches,
+// then all threads drain the shared queue; pushes and pops are logged with
+// timestamps for the rank error replay after the timed region
+#if defined(TMT_THREADS)
+template <typename Shared>
+void mt_workload(Shared & shared, const vector<int> & v, const bench_config & cfg, bench_record & rec) {
+    // workers and logs are set up before the timer
+    const size_t N = v.size();
+    const unsigned mt_threads = TMT_THREADS;
+#if defined(TMT_SPLIT)
+    const bool mt_split = mt_threads > 1;
 #else
-    chosen_pri_queue pq;
+    const bool mt_split = false;
+#endif
+    const unsigned mt_producers = mt_split ? mt_threads / 2 : mt_threads;
+    par::thread_pool mt_pool(mt_threads);
+    std::vector<std::vector<rank_error::event>> mt_logs(mt_threads);
+    for (unsigned t=0;t<mt_threads;t++)
+        mt_logs[t].reserve(3*N/mt_producers);
+
+    //// start timer
+    itt_resume();
+    timed_region_begin();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> popped_total{0};
+    std::vector<uint64_t> thread_ops(mt_threads, 0);
+    mt_pool.run([&](unsigned t) {
+        auto h = shared.get_handle();
+        auto & log = mt_logs[t];
+        std::mt19937 rng(cfg.seed + t);
+        // split mode: the first half of the threads only push, the rest only pop
+        const bool producer = t < mt_producers, consumer = !mt_split || t >= mt_producers;
+        const size_t lo = producer ? par::chunk_begin(N, mt_producers, t) : 0;
+        const size_t hi = producer ? par::chunk_begin(N, mt_producers, t + 1) : 0;
+        size_t remaining = hi - lo, outstanding = 0, popped = 0;
+        int key;
+        while (remaining > 0) {
+            const size_t push_batch_size = mt_split ? remaining : 1 + rng() % remaining;
+            for (size_t n = 0; n < push_batch_size; n++) {
+                // stamped before the push, so it is never replayed after its pop
+                const int k = v[lo + --remaining];
+                log.push_back(rank_error::event{rank_error::timestamp(), static_cast<uint32_t>(k), false});
+                h.push(k);
+            }
+            outstanding += push_batch_size;
+            const size_t pop_batch_size = consumer ? 1 + rng() % outstanding : 0;
+            for (size_t n = 0; n < pop_batch_size; n++) {
+                if (!h.try_pop(key))
+                    break;
+                log.push_back(rank_error::event{rank_error::timestamp(), static_cast<uint32_t>(key), true});
+                popped++;
+                outstanding--;
+            }
+        }
+        h.flush();
+        popped_total.fetch_add(popped, std::memory_order_relaxed);
+        while (consumer && popped_total.load(std::memory_order_relaxed) < N) {
+            if (h.try_pop(key)) {
+                log.push_back(rank_error::event{rank_error::timestamp(), static_cast<uint32_t>(key), true});
+                popped++;
+                popped_total.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        thread_ops[t] = (hi - lo) + popped;
+    });
+    assert(N==popped_total.load());
+    timed_region_end();
+    itt_pause();
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    const uint64_t elapsed_time_us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+    // replay outside the timed region; a strict queue scores ~0 (timestamp skew only)
+    const rank_error::summary re = rank_error::replay(mt_logs, N);
+    uint64_t ops = 0;
+    for (const auto n : thread_ops) ops += n;
+    const double secs = std::max<uint64_t>(elapsed_time_us, 1) / 1e6;
+    rec.add("mt_threads", mt_threads);
+    rec.add("mt_roles", mt_split ? "split" : "mixed");
+    rec.add("ops", ops);
+    rec.add("mops_per_s", ops / secs / 1e6);
+    rec.add("rank_error_mean", re.mean);
+    rec.add("rank_error_p99", re.p99);
+    rec.add("rank_error_max", re.max);
+    assert(re.pops == N);
+    rec.add("elapsed_time_us", elapsed_time_us);
+    // the counters follow the calling thread, which is worker 0
+    report_perf(rec, thread_ops[0]);
+}
 #endif
-    printf("[TEST] {\"size\": [%lu]}\n",N);
 
+// candidate details reported after the run (E's pages stay committed, so
+// this is the peak huge page coverage)
+template <typename Cand, typename PQ>
+void report_queue(const PQ & pq, bench_record & rec) {
+    if constexpr (std::is_same<Cand, cand_E>::value && !std::is_same<PQ, IndexedMinHeap>::value &&
+                  !std::is_same<PQ, TopKHeap>::value) {
+        rec.add("mem", STR(TMEM));
+        rec.add("pages", pq.isGrowable() ? heap_pages_name(pq.pageKind()) : "default");
+        rec.add("huge_page_kb", resident_huge_kb(pq.data()));
+    }
+    if constexpr (std::is_same<Cand, cand_F>::value && std::is_same<PQ, cand_F::queue_II>::value)
+        rec.add("radix_key", STR(TRADIX_KEY));
+    if constexpr (std::is_same<Cand, cand_B>::value || std::is_same<Cand, cand_C>::value || std::is_same<Cand, cand_D>::value)
+        rec.add("alloc", STR(TALLOC));
+    if constexpr (std::is_same<Cand, cand_H>::value) {
+        rec.add("shards", pq.shard_count());
+        rec.add("mq_buffer", (size_t)MULTIQUEUE_BUFFER);
+    }
+    (void)pq; (void)rec;
+}
+
+template <typename Cand>
+void run_I(const bench_config & cfg, bench_record & rec) {
+    using PQ = typename Cand::queue_I;
+    const size_t N = cfg.size;
+
+    // inputs and buffers first, so the memory snapshot only sees the queue
+    test_I_stream s(N, cfg.seed);
+    const std::vector<int> & v = s.keys;
+#if defined(TBATCH) && !defined(TMT_THREADS)
+    // batched mode: hand each batch to the queue's bulk API in one call
+    std::vector<int> pop_buf = std::vector<int>(N);
+#endif
+#if defined(TLATENCY) && !defined(TMT_THREADS)
+    // with batch=1 one record is a whole bulk call
+    auto lat = make_unique<op_latency>();
+#endif
+
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    [[maybe_unused]] node_resource_scope node_resource;
+    auto pq_ptr = Cand::make_I(N);
+    PQ & pq = *pq_ptr;
+
+    rec.add("api", TBATCH_API);
+    if constexpr (std::is_same<Cand, cand_E>::value) {
+        rec.add("arity", PQ::arity);
+        rec.add("simd", PQ::simd);
+    }
 
-//// random add and pop elements
-#if defined(TTYPE_I)
     uint32_t total_cnt = N;
     uint32_t total_rm_cnt = 0;
-    
-    std::vector<int> v = std::vector<int>(N);
-    for (int i=0;i<N;i++) v[i]=i;
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(v.begin(), v.end(), g);
+    uint32_t live = 0, max_live = 0;
+
+#if defined(TMT_THREADS)
+    // the worker logs are allocated after the snapshot, so no memory report
+    if constexpr (has_handles<PQ>::value) {
+        mt_workload(pq, v, cfg, rec);
+    } else {
+        locked_priqueue<PQ,int> shared(pq);
+        mt_workload(shared, v, cfg, rec);
+    }
+    (void)total_cnt; (void)total_rm_cnt; (void)live; (void)max_live; (void)mem;
+#else
 
     //// start timer
     itt_resume();
-    itt_task_begin();
+    timed_region_begin();
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
     while (total_cnt!=0 || !pq.empty()) {
         // random add some elements
         if (total_cnt>0){
-            auto push_batch_size = 1 + rand() % total_cnt;
+            auto push_batch_size = s.batch(total_cnt);
+#if defined(TBATCH)
+            TIMED_OP(lat->push, pq_push_bulk(pq, v.data() + (total_cnt-push_batch_size), push_batch_size));
+            total_cnt -= push_batch_size;
+#else
             for(uint32_t n=0;n<push_batch_size;n++) {
-                pq.push(v.at(total_cnt-1));
+                TIMED_OP(lat->push, pq.push(v.at(total_cnt-1)));
                 total_cnt -= 1;
             }
+#endif
+            live += push_batch_size;
+            max_live = std::max(max_live, live);
         }
-        auto pop_batch_size = 1 + rand() % pq.size();
+        auto pop_batch_size = s.batch(live);
+#if defined(TBATCH)
+        TIMED_OP(lat->pop, total_rm_cnt += pq_pop_n(pq, pop_buf.data(), pop_batch_size));
+#else
         for(uint32_t n=0;n<pop_batch_size;n++) {
-            pq.pop();
+            TIMED_OP(lat->pop, pq.pop());
             total_rm_cnt++;
         }
+#endif
+        live -= pop_batch_size;
     }
     assert(N==total_rm_cnt);
-    itt_task_end();
+    assert(pq.size()==0);
+    timed_region_end();
     itt_pause();
 
-#endif // TTYPE_I
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    rec.add("elapsed_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    report_perf(rec, 2*N);
+#if defined(TLATENCY)
+    lat->report(rec);
+#endif
+    report_memory(rec, mem, max_live);
+#endif
+    report_queue<Cand>(pq, rec);
+}
 
-//// find shortest path in graph
-#if defined(TTYPE_II)
 
-    // define graph
-    Graph g;
+//// trace replay: the recorded op stream, byte-identical for every candidate
 
-    static uint32_t NODE_NUM = N;
-    static uint32_t EDGE_NUM = 2*N;
-    // rand gen data
-    int edge_cnt = 0;
-    srand(123);
+template <typename Cand>
+void run_trace(const bench_config & cfg, bench_record & rec) {
+    using PQ = typename Cand::queue_I;
+    const op_trace::trace & t = *cfg.trace;
+#if defined(TLATENCY)
+    auto lat = make_unique<op_latency>();
+#endif
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    [[maybe_unused]] node_resource_scope node_resource;
+    auto pq_ptr = Cand::make_I(std::max<uint64_t>(t.max_size(), 1));
+    PQ & pq = *pq_ptr;
 
-    auto rd_double = [] (double a=0.0, double b=10.0) {
-        return a + (double) rand() / RAND_MAX * (b-a);
-    };
+    //// start timer
+    itt_resume();
+    timed_region_begin();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
-    auto rd_node = [] (int a, int b) {
-        return a + (int) ((double) rand() / RAND_MAX * (double) (b-a));
-    };
+#if defined(TLATENCY)
+    // op_trace::replay with every op timed
+    const int32_t * key = t.keys();
+    uint64_t checksum = op_trace::fold_seed;
+    for (const uint8_t * op = t.ops_begin(), * op_end = t.ops_end(); op != op_end; ++op) {
+        int top_key;
+        switch (*op) {
+        case op_trace::op_push:
+            TIMED_OP(lat->push, pq.push(*key++));
+            break;
+        case op_trace::op_pop:
+            TIMED_OP(lat->top, top_key = pq.top());
+            checksum = op_trace::fold(checksum, top_key);
+            TIMED_OP(lat->pop, pq.pop());
+            break;
+        default:
+            TIMED_OP(lat->top, top_key = pq.top());
+            checksum = op_trace::fold(checksum, top_key);
+            break;
+        }
+    }
+#else
+    const uint64_t checksum = op_trace::replay(pq, t);
+#endif
+
+    timed_region_end();
+    itt_pause();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    char hex[24];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)checksum);
+    rec.add("ops", t.op_count());
+    rec.add("pushes", t.key_count());
+    rec.add("pops", t.pop_count());
+    rec.add("max_size", t.max_size());
+    rec.add("trace_checksum", hex);
+    rec.add("elapsed_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    report_perf(rec, t.op_count());
+#if defined(TLATENCY)
+    lat->report(rec);
+#endif
+    report_memory(rec, mem, t.max_size());
+    report_queue<Cand>(pq, rec);
+}
+
+
+//// TEST III: hold model at a fixed queue size (hold_model.h)
+
+template <typename Cand>
+unique_ptr<typename Cand::queue_III> make_hold_queue(size_t N) {
+    if constexpr (std::is_same<typename Cand::queue_III, typename Cand::queue_I>::value)
+        return Cand::make_I(N);
+    else
+        return Cand::make_III(N);
+}
+
+// fill keys and hold increments of a type III or IV cell
+static hold_model::workload hold_workload(const bench_config & cfg, size_t holds) {
+    hold_model::dist d = hold_model::dist::exp;
+    hold_model::fill f = hold_model::fill::random;
+    hold_model::parse(cfg.dist, d); // names were checked in main
+    hold_model::parse(cfg.fill, f);
+    return hold_model::make(cfg.size, holds, d, f, cfg.seed);
+}
+
+template <typename Cand>
+void run_III(const bench_config & cfg, bench_record & rec) {
+    using PQ = typename Cand::queue_III;
+    const size_t N = cfg.size;
+    const size_t holds = hold_model::holds_per_element * N;
+    const hold_model::workload w = hold_workload(cfg, holds);
+#if defined(TLATENCY)
+    auto lat = make_unique<op_latency>();
+#endif
+
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    [[maybe_unused]] node_resource_scope node_resource;
+    auto pq_ptr = make_hold_queue<Cand>(N);
+    PQ & pq = *pq_ptr;
+    if constexpr (std::is_same<Cand, cand_E>::value) {
+        rec.add("arity", PQ::arity);
+        rec.add("simd", PQ::simd);
+    }
+
+    // the fill is timed on its own: its order shapes the queue the holds run on
+    std::chrono::steady_clock::time_point fill_begin = std::chrono::steady_clock::now();
+    for (const int key : w.fill_keys)
+        pq.push(key);
+    std::chrono::steady_clock::time_point fill_end = std::chrono::steady_clock::now();
+
+    //// start timer
+    itt_resume();
+    timed_region_begin();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    // every hold: pop the minimum, push it back advanced by the next increment
+    uint64_t checksum = op_trace::fold_seed;
+    for (size_t h = 0; h < holds; h++) {
+        int key;
+        TIMED_OP(lat->top, key = pq.top());
+        TIMED_OP(lat->pop, pq.pop());
+        checksum = op_trace::fold(checksum, key);
+        TIMED_OP(lat->push, pq.push(key + w.hold_increments[h]));
+    }
+
+    timed_region_end();
+    itt_pause();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    assert(pq.size() == N);
+
+    // equal for every strict candidate: ties hold equal keys, so the popped keys do not depend on tie order
+    char hex[24];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)checksum);
+    rec.add("holds", holds);
+    rec.add("hold_checksum", hex);
+    rec.add("fill_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(fill_end - fill_begin).count());
+    rec.add("elapsed_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    report_perf(rec, 2*holds);
+#if defined(TLATENCY)
+    lat->report(rec);
+#endif
+    report_memory(rec, mem, N);
+    report_queue<Cand>(pq, rec);
+}
+
+
+//// TEST IV: discrete event simulation, hold model with event records (des_workload.h)
+
+template <typename Cand, typename Store>
+void run_IV(const bench_config & cfg, bench_record & rec) {
+    using Ev = des::event<typename Store::body>;
+    using PQ = typename Cand::template queue_IV<Ev>;
+    const size_t N = cfg.size;
+    const size_t holds = hold_model::holds_per_element * N;
+    const hold_model::workload w = hold_workload(cfg, holds);
+#if defined(TLATENCY)
+    auto lat = make_unique<op_latency>();
+#endif
+
+    // the records belong to the queue's footprint: made after the snapshot
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    [[maybe_unused]] node_resource_scope node_resource;
+    Store store(N);
+    auto pq_ptr = make_event_queue<Cand, Ev>(N);
+    PQ & pq = *pq_ptr;
+    if constexpr (std::is_same<Cand, cand_E>::value) {
+        rec.add("arity", PQ::arity);
+        rec.add("simd", PQ::simd);
+    }
+    rec.add("event_bytes", sizeof(Ev));
+
+    std::chrono::steady_clock::time_point fill_begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < N; i++)
+        push_event(pq, Ev{w.fill_keys[i], store.make(i)});
+    std::chrono::steady_clock::time_point fill_end = std::chrono::steady_clock::now();
+
+    //// start timer
+    itt_resume();
+    timed_region_begin();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    // every event: take the earliest, run its handler on the record, and
+    // schedule it again with the same record
+    uint64_t checksum = op_trace::fold_seed;
+    for (size_t h = 0; h < holds; h++) {
+        Ev ev;
+        TIMED_OP(lat->pop, ev = take_top(pq));
+        checksum = op_trace::fold(checksum, ev.time);
+        des::handle(store.get(ev.body), ev.time);
+        ev.time += w.hold_increments[h];
+        TIMED_OP(lat->push, push_event(pq, std::move(ev)));
+    }
+
+    timed_region_end();
+    itt_pause();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    assert(pq.size() == N);
+
+    // the event times, like hold_checksum: equal for every candidate
+    char hex[24];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)checksum);
+    rec.add("holds", holds);
+    rec.add("event_checksum", hex);
+    rec.add("fill_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(fill_end - fill_begin).count());
+    rec.add("elapsed_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    report_perf(rec, 2*holds);
+#if defined(TLATENCY)
+    lat->report(rec);
+#endif
+    report_memory(rec, mem, N);
+    report_queue<Cand>(pq, rec);
+}
+
+template <typename Cand, size_t Bytes>
+void run_IV_store(const bench_config & cfg, bench_record & rec) {
+    des::store kind = des::store::inline_record;
+    des::parse(cfg.store, kind);
+    if (kind == des::store::inline_record)
+        run_IV<Cand, des::inline_store<Bytes>>(cfg, rec);
+    else if (kind == des::store::indirect)
+        run_IV<Cand, des::indirect_store<Bytes>>(cfg, rec);
+    else if constexpr (Cand::skip_IV_move[0] == '\0')
+        run_IV<Cand, des::move_store<Bytes>>(cfg, rec);
+}
+
+// one instantiation per record size of des::record_sizes
+template <typename Cand>
+void run_IV_payload(const bench_config & cfg, bench_record & rec) {
+    switch (cfg.payload) {
+    case 8: run_IV_store<Cand, 8>(cfg, rec); break;
+    case 32: run_IV_store<Cand, 32>(cfg, rec); break;
+    case 64: run_IV_store<Cand, 64>(cfg, rec); break;
+    case 128: run_IV_store<Cand, 128>(cfg, rec); break;
+    default: assert(!"payload sizes are checked in main");
+    }
+}
+
+
+//// TEST V: the k largest keys of a stream
+
+// the stream of one cell: N keys drawn uniformly from [0, INT_MAX]
+static vector<int> topk_stream(size_t N, uint64_t seed) {
+    std::mt19937_64 rng(seed ^ 0xBB67AE8584CAA73Bull);
+    vector<int> keys(N);
+    for (auto & x : keys)
+        x = static_cast<int>(rng() >> 33);
+    return keys;
+}
+
+// keys per batch the stream hands to a queue with a bulk offer (E)
+constexpr size_t topk_batch = 4096;
+
+template <typename PQ, typename = void>
+struct has_offer_bulk : std::false_type {};
+
+template <typename PQ>
+struct has_offer_bulk<PQ, std::void_t<decltype(std::declval<PQ&>().offer_bulk(nullptr, size_t(0)))>> : std::true_type {};
+
+template <typename Cand>
+unique_ptr<typename Cand::queue_V> make_select_queue(size_t k) {
+    if constexpr (std::is_same<typename Cand::queue_V, typename Cand::queue_I>::value)
+        return Cand::make_I(k);
+    else
+        return Cand::make_V(k);
+}
 
-    for (int _=0; _<EDGE_NUM; _++){
-        auto e = Edge(rd_node(0,NODE_NUM),rd_node(0,NODE_NUM),ceil(rd_double()));
-        if(e.u!=e.v && !g.has_edge(e)) { //do not add edge if u==v
-            g.add_edge(e);
-            // cout << "[dij] added edge : " << e.repr() << endl;
-            edge_cnt++;
+// keep the k largest keys of the stream in pq and write them to out in
+// descending order; returns how many keys replaced the threshold. A plain
+// min-queue is bounded by hand: it takes the first k keys, then every key
+// above its top replaces the top (pop, then push)
+template <typename PQ>
+uint64_t select_top_k(PQ & pq, const vector<int> & stream, size_t k, int * out) {
+    if constexpr (has_offer_bulk<PQ>::value) {
+        for (size_t i = 0; i < stream.size(); i += topk_batch)
+            pq.offer_bulk(stream.data() + i, std::min(topk_batch, stream.size() - i));
+        pq.take_sorted(out);
+        return pq.replacements();
+    } else {
+        uint64_t replaced = 0;
+        size_t i = 0;
+        for (; i < stream.size() && static_cast<size_t>(pq.size()) < k; i++)
+            pq.push(stream[i]);
+        for (; i < stream.size(); i++)
+            if (stream[i] > pq.top()) {
+                pq.pop();
+                pq.push(stream[i]);
+                replaced++;
+            }
+        for (size_t j = pq.size(); j-- > 0;) {
+            out[j] = pq.top();
+            pq.pop();
         }
+        return replaced;
+    }
+}
+
+// the selected keys, equal for every candidate and reference
+static void report_top_k(bench_record & rec, const vector<int> & best) {
+    uint64_t checksum = op_trace::fold_seed;
+    for (const int key : best)
+        checksum = op_trace::fold(checksum, key);
+    char hex[24];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)checksum);
+    rec.add("kth_key", best.back());
+    rec.add("topk_checksum", hex);
+}
+
+template <typename Cand>
+void run_V(const bench_config & cfg, bench_record & rec) {
+    using PQ = typename Cand::queue_V;
+    const size_t k = cfg.k;
+    const vector<int> stream = topk_stream(cfg.size, cfg.seed);
+    vector<int> best(k);
+
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    [[maybe_unused]] node_resource_scope node_resource;
+    auto pq_ptr = make_select_queue<Cand>(k);
+    PQ & pq = *pq_ptr;
+    if constexpr (std::is_same<Cand, cand_E>::value) {
+        rec.add("arity", PQ::arity);
+        rec.add("simd", PQ::simd);
+    }
+
+    //// start timer (includes the final sorted extraction)
+    itt_resume();
+    timed_region_begin();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    const uint64_t replaced = select_top_k(pq, stream, k, best.data());
+
+    timed_region_end();
+    itt_pause();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    rec.add("replacements", replaced);
+    report_top_k(rec, best);
+    rec.add("elapsed_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    report_perf(rec, cfg.size);
+    report_memory(rec, mem, k);
+    report_queue<Cand>(pq, rec);
+}
+
+// reference selections over the buffered stream, in place. The buffer is
+// their footprint, so the stream is made after the memory snapshot
+static const char * const reference_names[] = {"partial_sort", "nth_element"};
+
+static void run_V_reference(const bench_config & cfg, bench_record & rec) {
+    const size_t k = cfg.k;
+    vector<int> best(k);
+
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    vector<int> stream = topk_stream(cfg.size, cfg.seed);
+
+    //// start timer
+    itt_resume();
+    timed_region_begin();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    if (cfg.cand == "partial_sort") {
+        std::partial_sort(stream.begin(), stream.begin() + k, stream.end(), greater<int>());
+    } else {
+        // the k largest end up in front, unordered: sort them as well
+        std::nth_element(stream.begin(), stream.begin() + (k - 1), stream.end(), greater<int>());
+        std::sort(stream.begin(), stream.begin() + k, greater<int>());
+    }
+    std::copy(stream.begin(), stream.begin() + k, best.begin());
+
+    timed_region_end();
+    itt_pause();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    report_top_k(rec, best);
+    rec.add("elapsed_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    report_perf(rec, cfg.size);
+    report_memory(rec, mem, cfg.size);
+}
+
+
+//// TEST II: find shortest path in graph
+
+// the generated graph of the last (size, seed), shared by every candidate and
+// repetition of a sweep; loaded from / saved to the on-disk cache
+struct graph_slot {
+    graph_cache::key gkey{};
+    Graph g;
+    bool valid = false;
+};
+
+static const Graph & graph_for(const bench_config & cfg, bench_record & rec) {
+    static graph_slot slot;
+    const uint32_t NODE_NUM = cfg.size;
+    const uint32_t EDGE_NUM = 2*cfg.size;
+    // graph generation is seeded and counter-based, so the graph (and thus the
+    // result) does not depend on the thread count
+    const uint64_t GEN_SEED = cfg.seed;
+    const unsigned gen_threads = TGEN_THREADS;
+    const graph_cache::key gkey{GEN_SEED, NODE_NUM, EDGE_NUM, graph_gen::version};
+
+    if (slot.valid && std::memcmp(&slot.gkey, &gkey, sizeof(gkey)) == 0) {
+        rec.add("graph_cache", "reuse");
+        rec.add("gen_threads", gen_threads);
+        rec.add("load_time_us", 0);
+        rec.add("gen_time_us", 0);
+        rec.add("build_time_us", 0);
+        return slot.g;
+    }
+    slot.valid = false;
+    slot.g = Graph();
+
+    // map the graph from the cache when this (seed, N, edges) was generated before
+    const std::string gcache_dir = TGRAPH_CACHE;
+    const bool gcache_on = gcache_dir != "off";
+    const std::string gcache_path = gcache_on ? graph_cache::path_for(gcache_dir, gkey) : std::string();
+
+    std::chrono::steady_clock::time_point load_begin = std::chrono::steady_clock::now();
+    Graph g = gcache_on ? graph_cache::load(gcache_path, gkey) : Graph();
+    const bool gcache_hit = g.node_num() != 0;
+    std::chrono::steady_clock::time_point gen_begin = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point build_begin = gen_begin;
+    std::chrono::steady_clock::time_point build_end = gen_begin;
+
+    if (!gcache_hit) {
+        // edge list; an undirected pair is kept on its first occurrence
+        vector<graph_gen::gen_edge> edges = graph_gen::generate_edges(NODE_NUM, EDGE_NUM, GEN_SEED, gen_threads);
+
+        build_begin = std::chrono::steady_clock::now();
+
+        // define graph
+        g = graph_gen::build_csr(NODE_NUM, edges, gen_threads);
+
+        build_end = std::chrono::steady_clock::now();
+        vector<graph_gen::gen_edge>().swap(edges);
+
+        if (gcache_on && !graph_cache::save(gcache_path, gkey, g))
+            cerr << "[dij] could not write graph cache " << gcache_path << endl;
     }
 
-    cout << "[dij] prepared edge size : " << edge_cnt << endl;
+    cerr << "[dij] prepared edge size : " << g.edge_num() << endl;
+    rec.add("graph_cache", !gcache_on ? "off" : (gcache_hit ? "hit" : "miss"));
+    rec.add("gen_threads", gen_threads);
+    rec.add("load_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(gen_begin - load_begin).count());
+    rec.add("gen_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(build_begin - gen_begin).count());
+    rec.add("build_time_us", (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(build_end - build_begin).count());
+
+    slot.gkey = gkey;
+    slot.g = std::move(g);
+    slot.valid = true;
+    return slot.g;
+}
+
+// source node s of a TEST II cell (drawn right after the edges' counters)
+static int source_II(const bench_config & cfg) {
+    const uint32_t NODE_NUM = cfg.size;
+    const uint32_t EDGE_NUM = 2*cfg.size;
+    return graph_gen::uniform(graph_gen::rng_at(cfg.seed, graph_gen::draws_per_edge * EDGE_NUM), NODE_NUM);
+}
+
+static double dist_checksum(const vector<double> & dist_info_vec) {
+    double sum = 0.0;
+    for (const auto d : dist_info_vec)
+        if (d != DBL_MAX) sum += d;
+    return sum;
+}
+
+#if defined(TDIJ_delta)
+// delta-stepping uses no queue, so TEST II is one candidate-independent
+// cell ("cand": "delta") instead of one per candidate
+void run_II_delta(const bench_config & cfg, bench_record & rec) {
+    const Graph & g = graph_for(cfg, rec);
+    const uint32_t NODE_NUM = cfg.size;
+    const int s = source_II(cfg);
 
-    // define source node s
-    const int s = rd_node(0,NODE_NUM);
+    vector<double> dist_info_vec (NODE_NUM,DBL_MAX);
+    dist_info_vec[s] = 0.0;
+
+    cerr << "[dij] source node : " << s << endl;
+
+    // graph and distance arrays are in place, so the snapshot only sees the buckets
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    // threads are started before the timer
+    delta_stepping sssp(g, TSSSP_THREADS, TDELTA > 0.0 ? TDELTA : delta_stepping::default_delta(g));
+
+    //// start timer
+    itt_resume();
+    timed_region_begin();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    const delta_stepping::stats sssp_stats = sssp.run(s, dist_info_vec);
+
+    timed_region_end();
+    itt_pause();
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    const uint64_t elapsed_time_us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+    // pushes are successful relaxations, stale pops skipped bucket entries
+    rec.add("dij", STR(TDIJ));
+    rec.add("pushes", sssp_stats.relaxations);
+    rec.add("stale_pops", sssp_stats.stale_entries);
+    rec.add("decrease_keys", 0);
+    rec.add("max_pq_size", sssp_stats.max_frontier);
+    rec.add_fixed("dist_checksum", dist_checksum(dist_info_vec), 1);
+    rec.add("sssp_threads", sssp.threads());
+    rec.add("delta", sssp.bucket_width());
+    rec.add("buckets", sssp_stats.buckets);
+    rec.add("light_phases", sssp_stats.light_phases);
+#if defined(TSSSP_VERIFY)
+    // sequential reference outside the timed region; distances must match exactly
+    {
+        vector<double> ref (NODE_NUM,DBL_MAX);
+        std::priority_queue<NODE_M,vector<NODE_M>,greater<NODE_M>> ref_pq;
+        ref[s] = 0.0;
+        ref_pq.push(NODE_M(s,0.0));
+        while(!ref_pq.empty()){
+            const NODE_M m = ref_pq.top();
+            ref_pq.pop();
+            if (m.dist_to_s > ref[m.node]) continue;
+            for (const auto&arc : g.neighbors(m.node))
+                if (m.dist_to_s + arc.d < ref[arc.to]) {
+                    ref[arc.to] = m.dist_to_s + arc.d;
+                    ref_pq.push(NODE_M(arc.to,ref[arc.to]));
+                }
+        }
+        const bool match = (ref == dist_info_vec);
+        rec.add("dist_match", match ? "ok" : "MISMATCH");
+        assert(match);
+    }
+#endif
+    rec.add("elapsed_time_us", elapsed_time_us);
+    report_perf(rec, 2*sssp_stats.relaxations);
+    report_memory(rec, mem, sssp_stats.max_frontier);
+}
+#else
+template <typename Cand>
+void run_II(const bench_config & cfg, bench_record & rec) {
+    using PQ = typename Cand::queue_II;
+    const size_t N = cfg.size;
+    const Graph & g = graph_for(cfg, rec);
+    const uint32_t NODE_NUM = N;
+    const int s = source_II(cfg);
 
     // store all distances from source s
     vector<double> dist_info_vec (NODE_NUM,DBL_MAX); //store distance s to key node
     dist_info_vec[s] = 0.0;
+    vector<int> prev_info_vec (NODE_NUM,-1); //store the prev node to key node
+
+    cerr << "[dij] source node : " << s << endl;
+    cerr << "[dij] prepared dist info of size : " << dist_info_vec.size() << endl;
+#if defined(TLATENCY)
+    auto lat = make_unique<op_latency>();
+#endif
+
+    // graph and distance arrays are in place, so the snapshot only sees the queue
+    const mem_tracking::snapshot mem = mem_tracking::begin();
+    [[maybe_unused]] node_resource_scope node_resource;
+    auto pq_ptr = Cand::make_II(N);
+    PQ & pq = *pq_ptr;
+    if constexpr (std::is_same<Cand, cand_E>::value) {
+        rec.add("arity", PQ::arity);
+        rec.add("simd", PQ::simd);
+    }
 
-    cout << "[dij] source node : " << s << endl;
-    cout << "[dij] prepared dist info of size : " << dist_info_vec.size() << endl;
- 
-    
     //// start timer
     itt_resume();
-    itt_task_begin();
+    timed_region_begin();
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
-    pq.push(NODE_M(s,0.0));
-
     // find the shortest path from source s to each node
-    map<int,int> prev_info_map; //store the prev node to key node
+    // frontier statistics: lazy mode pushes on every improvement and later pops
+    // the superseded entries; dk mode updates the queued entry in place instead
+    uint64_t push_cnt = 0, stale_pop_cnt = 0, decrease_cnt = 0;
+    size_t max_pq_size = 0;
 
-    while(pq.size()>0){
-        auto min_node_m = pq.top(); 
-        pq.pop();
-        // cout << "popped min_node:" << min_node_m.repr() << "|" << g.get_list(min_node_m.node).size() << endl;
-        for (const auto&neighbour_node : g.get_list(min_node_m.node)){
-            double new_dist = dist_info_vec[min_node_m.node] + g.get_dist(min_node_m.node,neighbour_node);
-            // cout << "new_dist" << new_dist << "| nn:" << neighbour_node << "," << dist_info_vec[neighbour_node] << endl;
+#if defined(TDIJ_dk)
+    pq.push(s,0.0);
+    push_cnt++;
+
+    while(!pq.empty()){
+        max_pq_size = std::max(max_pq_size,pq.size());
+        int min_node;
+        TIMED_OP(lat->top, min_node = pq.top_id());
+        TIMED_OP(lat->pop, pq.pop());
+        for (const auto&arc : g.neighbors(min_node)){
+            const int neighbour_node = arc.to;
+            double new_dist = dist_info_vec[min_node] + arc.d;
             if (new_dist<dist_info_vec[neighbour_node]) {
                 dist_info_vec[neighbour_node] = new_dist;
-                prev_info_map[neighbour_node] = min_node_m.node;
-                pq.push(NODE_M(neighbour_node,new_dist));
-                // cout << ">> pushed:" << neighbour_node << "|" << new_dist << std::endl;
+                prev_info_vec[neighbour_node] = min_node;
+                if (pq.contains(neighbour_node)) {
+                    TIMED_OP(lat->decrease_key, pq.decrease_key(neighbour_node,new_dist));
+                    decrease_cnt++;
+                } else {
+                    TIMED_OP(lat->push, pq.push(neighbour_node,new_dist));
+                    push_cnt++;
+                }
             }
         }
     }
+#else
+    pq.push(NODE_M(s,0.0));
+    push_cnt++;
 
-    //// list all dist and prev info
-    // cout << "[dij] min dist to each node and their prev node : ";
-    // for (int i=0; i < NODE_NUM; i++){
-    //     cout << "node : " << i << " | ";
-    //     cout << "dist : " << dist_info_vec[i] << " | ";
-    //     cout << "prev : " << ((prev_info_map.count(i)) ? prev_info_map[i] : -1) << endl;
-    // }
-
-
-#endif // TTYPE_II
+    while(pq.size()>0){
+        max_pq_size = std::max(max_pq_size,(size_t)pq.size());
+        NODE_M min_node_m;
+        TIMED_OP(lat->top, min_node_m = pq.top());
+        TIMED_OP(lat->pop, pq.pop());
+        if (min_node_m.dist_to_s > dist_info_vec[min_node_m.node])
+            stale_pop_cnt++; // superseded by a later push of the same node
+        for (const auto&arc : g.neighbors(min_node_m.node)){
+            const int neighbour_node = arc.to;
+            double new_dist = dist_info_vec[min_node_m.node] + arc.d;
+            if (new_dist<dist_info_vec[neighbour_node]) {
+                dist_info_vec[neighbour_node] = new_dist;
+                prev_info_vec[neighbour_node] = min_node_m.node;
+                TIMED_OP(lat->push, pq.push(NODE_M(neighbour_node,new_dist)));
+                push_cnt++;
+            }
+        }
+    }
+#endif
 
     assert(pq.size()==0);
-    itt_task_end();
+    timed_region_end();
     itt_pause();
 
     std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-    uint64_t elapsed_time_us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
-    if (!skip_test)
-        printf("[TEST] {\"elapsed_time_us\": [%lu]}\n",elapsed_time_us);
+    const uint64_t elapsed_time_us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+    rec.add("dij", STR(TDIJ));
+    rec.add("pushes", push_cnt);
+    rec.add("stale_pops", stale_pop_cnt);
+    rec.add("decrease_keys", decrease_cnt);
+    rec.add("max_pq_size", max_pq_size);
+    rec.add_fixed("dist_checksum", dist_checksum(dist_info_vec), 1);
+    rec.add("elapsed_time_us", elapsed_time_us);
+    // every push is popped once; a decrease-key replaces a push and its stale pop
+    report_perf(rec, 2*push_cnt + decrease_cnt);
+#if defined(TLATENCY)
+    lat->report(rec);
+#endif
+    report_memory(rec, mem, max_pq_size);
+    report_queue<Cand>(pq, rec);
+}
+#endif
+
+
+// workload parameters of types III, IV and V
+static void add_variant(const bench_config & cfg, bench_record & rec) {
+    if (cfg.type == "V")
+        rec.add("k", cfg.k);
+    if (cfg.type != "III" && cfg.type != "IV")
+        return;
+    rec.add("dist", cfg.dist);
+    rec.add("fill", cfg.fill);
+    if (cfg.type == "IV") {
+        rec.add("payload", cfg.payload);
+        rec.add("store", cfg.store);
+    }
+}
+
+//// one cell: candidate x workload x size x repetition
+static void add_cell_header(const bench_config & cfg, bench_record & rec) {
+    rec.add("cand", cfg.cand);
+    rec.add("type", cfg.type);
+    if (!cfg.id.empty())
+        rec.add("id", cfg.id);
+    rec.add("size", cfg.size);
+    if (cfg.trace)
+        rec.add("trace", cfg.trace_file);
+    else
+        rec.add("seed", cfg.seed);
+    rec.add("rep", cfg.rep);
+    if (!cfg.cpus.empty())
+        rec.add("cpus", cfg.cpus);
+    add_variant(cfg, rec);
+}
+
+static void skip_cell(bench_record & rec, const char * why) {
+    rec.add("skipped", why);
+    rec.add("elapsed_time_us", "nan");
+}
+
+static const char * const topk_skip = "k exceeds the stream length";
+
+template <typename Cand>
+void run_cell(const bench_config & cfg, bench_record & rec) {
+    add_cell_header(cfg, rec);
+
+    using probe_IV = des::event<des::record<8>>;
+    const bool type_I = cfg.type == "I", type_trace = cfg.type == "trace", type_III = cfg.type == "III",
+               type_IV = cfg.type == "IV", type_V = cfg.type == "V";
+    const char * skip = type_I || type_trace ? Cand::skip_I : type_III ? Cand::skip_III :
+                        type_IV ? Cand::skip_IV : type_V ? Cand::skip_V : Cand::skip_II;
+    bool runs;
+    if (type_I || type_trace)
+        runs = !std::is_void<typename Cand::queue_I>::value;
+    else if (type_III)
+        runs = !std::is_void<typename Cand::queue_III>::value;
+    else if (type_IV)
+        runs = !std::is_void<typename Cand::template queue_IV<probe_IV>>::value;
+    else if (type_V)
+        runs = !std::is_void<typename Cand::queue_V>::value;
+    else
+        runs = !std::is_void<typename Cand::queue_II>::value;
+    if (type_IV && runs && cfg.store == "move" && Cand::skip_IV_move[0] != '\0') {
+        runs = false;
+        skip = Cand::skip_IV_move;
+    }
+    if constexpr (has_handles<typename Cand::queue_I>::value) {
+        if (type_trace || type_III || type_V) {
+            runs = false;
+            skip = "trace replay, the hold model and top-k are sequential: run H and I in a build without mt";
+        }
+    }
+    if (type_V && runs && cfg.k > cfg.size) {
+        runs = false;
+        skip = topk_skip;
+    }
+    if (!runs)
+        return skip_cell(rec, skip);
+
+    if (type_I) {
+        if constexpr (!std::is_void<typename Cand::queue_I>::value)
+            run_I<Cand>(cfg, rec);
+    } else if (type_trace) {
+        if constexpr (!std::is_void<typename Cand::queue_I>::value && !has_handles<typename Cand::queue_I>::value)
+            run_trace<Cand>(cfg, rec);
+    } else if (type_III) {
+        if constexpr (!std::is_void<typename Cand::queue_III>::value && !has_handles<typename Cand::queue_III>::value)
+            run_III<Cand>(cfg, rec);
+    } else if (type_IV) {
+        if constexpr (!std::is_void<typename Cand::template queue_IV<probe_IV>>::value)
+            run_IV_payload<Cand>(cfg, rec);
+    } else if (type_V) {
+        if constexpr (!std::is_void<typename Cand::queue_V>::value && !has_handles<typename Cand::queue_V>::value)
+            run_V<Cand>(cfg, rec);
+    } else {
+#if !defined(TDIJ_delta)
+        if constexpr (!std::is_void<typename Cand::queue_II>::value)
+            run_II<Cand>(cfg, rec);
+#endif
+    }
+}
+
+// partial_sort and nth_element: TEST V only
+static void run_reference_cell(const bench_config & cfg, bench_record & rec) {
+    add_cell_header(cfg, rec);
+    if (cfg.type != "V")
+        return skip_cell(rec, "reference selection: only TEST V is supported");
+    if (cfg.k > cfg.size)
+        return skip_cell(rec, topk_skip);
+    run_V_reference(cfg, rec);
+}
+
+static bool run_cell(const bench_config & cfg, bench_record & rec) {
+#if defined(TDIJ_delta)
+    if (cfg.cand == "delta") {
+        add_cell_header(cfg, rec);
+        if (cfg.type == "II")
+            run_II_delta(cfg, rec);
+        else
+            skip_cell(rec, "delta-stepping: only TEST II is supported");
+        return true;
+    }
+#endif
+    for (const char * name : reference_names)
+        if (cfg.cand == name) {
+            run_reference_cell(cfg, rec);
+            return true;
+        }
+    switch (cfg.cand.size() == 1 ? cfg.cand[0] : '?') {
+    case 'A': run_cell<cand_A>(cfg, rec); return true;
+    case 'B': run_cell<cand_B>(cfg, rec); return true;
+    case 'C': run_cell<cand_C>(cfg, rec); return true;
+    case 'D': run_cell<cand_D>(cfg, rec); return true;
+    case 'E': run_cell<cand_E>(cfg, rec); return true;
+    case 'F': run_cell<cand_F>(cfg, rec); return true;
+    case 'G': run_cell<cand_G>(cfg, rec); return true;
+    case 'H': run_cell<cand_H>(cfg, rec); return true;
+    case 'I': run_cell<cand_I>(cfg, rec); return true;
+    default: return false;
+    }
+}
+
+
+//// repetitions: pinning and the per-cell summary
+
+// pin the calling thread, and so every thread it starts later, to `cpus`
+static bool pin_to(const vector<string> & cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto & c : cpus) {
+        char * end = nullptr;
+        const long cpu = strtol(c.c_str(), &end, 10);
+        if (end == c.c_str() || *end != '\0' || cpu < 0 || cpu >= CPU_SETSIZE)
+            return false;
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// median, MAD and 95% bootstrap CI of elapsed_time_us over the repetitions
+// of one cell; tells repeatable differences between candidates from noise
+static void print_summary(const bench_config & cfg, const vector<double> & elapsed, unsigned warmup) {
+    const bench_stats::interval ci = bench_stats::bootstrap_median_ci(elapsed);
+    bench_record rec;
+    rec.add("cand", cfg.cand);
+    rec.add("type", cfg.type);
+    if (!cfg.id.empty())
+        rec.add("id", cfg.id);
+    rec.add("size", cfg.size);
+    if (cfg.trace)
+        rec.add("trace", cfg.trace_file);
     else
-        printf("[TEST] {\"elapsed_time_us\": [\"nan\"]}\n");
+        rec.add("seed", cfg.seed);
+    if (!cfg.cpus.empty())
+        rec.add("cpus", cfg.cpus);
+    add_variant(cfg, rec);
+    rec.add("stat", "summary");
+    rec.add("reps", elapsed.size());
+    rec.add("warmup", warmup);
+    rec.add("elapsed_median_us", bench_stats::median(elapsed));
+    rec.add("elapsed_mad_us", bench_stats::mad(elapsed));
+    rec.add("elapsed_ci_lo_us", ci.lo);
+    rec.add("elapsed_ci_hi_us", ci.hi);
+    rec.add("ci_level", 0.95);
+    rec.print();
+}
+
+
+int main(int argc, char ** argv)
+{
+    vector<string> cands = {"A"}, types = {"I"}, ids, dists = {"exp"}, fills = {"random"}, stores = {"inline"};
+    vector<size_t> payloads = {32}, ks = {1000};
+    vector<size_t> sizes;
+    uint64_t seed = 123;
+    unsigned reps = 1, warmup = 0;
+    string record_file, trace_file, pin;
+
+    for (int k = 1; k < argc; k++) {
+        const string arg = argv[k];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        }
+        if (k + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const string val = argv[++k];
+        if (arg == "--cand") {
+            cands = split_list(val);
+        } else if (arg == "--type") {
+            types = split_list(val);
+        } else if (arg == "--size") {
+            for (const auto & n : split_list(val))
+                sizes.push_back(static_cast<size_t>(strtod(n.c_str(), nullptr)));
+        } else if (arg == "--id") {
+            ids = split_list(val);
+        } else if (arg == "--seed") {
+            seed = strtoull(val.c_str(), nullptr, 0);
+        } else if (arg == "--reps") {
+            reps = static_cast<unsigned>(std::max(1l, strtol(val.c_str(), nullptr, 0)));
+        } else if (arg == "--warmup") {
+            warmup = static_cast<unsigned>(std::max(0l, strtol(val.c_str(), nullptr, 0)));
+        } else if (arg == "--pin") {
+            pin = val;
+        } else if (arg == "--dist") {
+            dists = split_list(val);
+        } else if (arg == "--fill") {
+            fills = split_list(val);
+        } else if (arg == "--payload") {
+            payloads.clear();
+            for (const auto & b : split_list(val))
+                payloads.push_back(static_cast<size_t>(strtoul(b.c_str(), nullptr, 0)));
+        } else if (arg == "--store") {
+            stores = split_list(val);
+        } else if (arg == "--k") {
+            ks.clear();
+            for (const auto & n : split_list(val))
+                ks.push_back(static_cast<size_t>(strtod(n.c_str(), nullptr)));
+        } else if (arg == "--record") {
+            record_file = val;
+        } else if (arg == "--trace") {
+            trace_file = val;
+            types = {"trace"};
+        } else {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // --id names sizes of the README matrix; --size takes any N
+    vector<pair<size_t,string>> cells;
+    for (const auto & id : ids) {
+        const auto * it = std::find_if(std::begin(test_id_names), std::end(test_id_names),
+                                      [&](const char * n) { return id == n; });
+        if (it == std::end(test_id_names)) {
+            fprintf(stderr, "unknown test id %s\n", id.c_str());
+            return 1;
+        }
+        cells.emplace_back(sample_size(static_cast<TEST_ID>(it - std::begin(test_id_names))), id);
+    }
+    for (const auto n : sizes)
+        cells.emplace_back(n, string());
+    if (cells.empty())
+        cells.emplace_back(sample_size(i), "i");
+
+    for (const auto & cell : cells) {
+        if (cell.first == 0) {
+            fprintf(stderr, "size must be at least 1\n");
+            return 1;
+        }
+    }
+
+    // --record: write the TEST I op stream of one cell instead of running candidates
+    if (!record_file.empty()) {
+        if (cells.size() != 1) {
+            fprintf(stderr, "--record takes exactly one size\n");
+            return 1;
+        }
+        const op_trace::writer w = record_I(cells[0].first, seed);
+        if (!w.save(record_file)) {
+            fprintf(stderr, "cannot write trace %s\n", record_file.c_str());
+            return 1;
+        }
+        bench_record rec;
+        rec.add("record", record_file);
+        rec.add("size", cells[0].first);
+        rec.add("seed", seed);
+        rec.add("ops", w.op_count());
+        rec.add("file_bytes", op_trace::make_header(w.op_count(), w.key_count()).file_bytes);
+        rec.print();
+        return 0;
+    }
+
+    // --trace: one cell per candidate, sized by the trace
+    op_trace::trace trace;
+    if (!trace_file.empty()) {
+        trace = op_trace::trace::open(trace_file);
+        if (!trace.valid()) {
+            fprintf(stderr, "%s: %s\n", trace_file.c_str(), trace.error().c_str());
+            return 1;
+        }
+        cells.assign(1, {trace.key_count(), string()});
+    }
+
+    for (const auto & t : types) {
+        if (t == "trace" && !trace.valid()) {
+            fprintf(stderr, "type trace needs --trace FILE\n");
+            return 1;
+        }
+        if (t != "I" && t != "II" && t != "III" && t != "IV" && t != "V" && t != "trace") {
+            fprintf(stderr, "unknown test type %s\n", t.c_str());
+            return 1;
+        }
+    }
+    for (const auto & name : dists) {
+        hold_model::dist d;
+        if (!hold_model::parse(name, d)) {
+            fprintf(stderr, "unknown distribution %s\n", name.c_str());
+            return 1;
+        }
+    }
+    for (const auto & name : fills) {
+        hold_model::fill f;
+        if (!hold_model::parse(name, f)) {
+            fprintf(stderr, "unknown fill order %s\n", name.c_str());
+            return 1;
+        }
+    }
+    for (const auto b : payloads) {
+        if (!des::supported_size(b)) {
+            fprintf(stderr, "payload must be one of 8, 32, 64, 128 bytes, not %zu\n", b);
+            return 1;
+        }
+    }
+    for (const auto & name : stores) {
+        des::store k;
+        if (!des::parse(name, k)) {
+            fprintf(stderr, "unknown store %s\n", name.c_str());
+            return 1;
+        }
+    }
+
+    for (const auto k : ks) {
+        if (k == 0 || k > UINT32_MAX) {
+            fprintf(stderr, "k must be between 1 and %u\n", UINT32_MAX);
+            return 1;
+        }
+    }
+
+    if (!pin.empty() && !pin_to(split_list(pin))) {
+        fprintf(stderr, "cannot pin to CPUs %s\n", pin.c_str());
+        return 1;
+    }
+
+    // type III runs every (distribution, fill) pair, type IV every
+    // (distribution, fill, payload, store), type V every k, the others one variant
+    struct variant {
+        string dist, fill;
+        size_t payload;
+        string store;
+        size_t k;
+    };
+    vector<variant> hold_variants, event_variants, select_variants;
+    for (const auto & d : dists)
+        for (const auto & f : fills) {
+            hold_variants.push_back({d, f, 0, string(), 0});
+            for (const auto b : payloads)
+                for (const auto & st : stores)
+                    event_variants.push_back({d, f, b, st, 0});
+        }
+    for (const auto k : ks)
+        select_variants.push_back({string(), string(), 0, string(), k});
+    const vector<variant> no_variants(1, variant{string(), string(), 0, string(), 0});
+#if defined(TDIJ_delta)
+    // no candidate queue takes part in TEST II: one cell for all of --cand
+    const vector<string> II_cands(1, "delta");
+#else
+    const vector<string> & II_cands = cands;
+#endif
+
+    // warmup runs, then the timed repetitions, each on fresh but identical
+    // inputs (a new queue, the same seeded keys or graph)
+    for (const auto & t : types)
+        for (const auto & cell : cells)
+            for (const auto & hv : t == "III" ? hold_variants : t == "IV" ? event_variants :
+                                   t == "V" ? select_variants : no_variants)
+                for (const auto & c : t == "II" ? II_cands : cands) {
+                    bench_config cfg{c, t, cell.second, cell.first, seed, 0,
+                                     t == "trace" ? &trace : nullptr, trace_file, pin,
+                                     hv.dist, hv.fill, hv.payload, hv.store, hv.k};
+                    vector<double> elapsed;
+                    for (unsigned r = 0; r < warmup + reps; r++) {
+                        bench_record rec;
+                        cfg.rep = r < warmup ? 0 : r - warmup;
+                        if (!run_cell(cfg, rec)) {
+                            fprintf(stderr, "unknown candidate %s\n", c.c_str());
+                            return 1;
+                        }
+                        if (r < warmup)
+                            continue;
+                        rec.print();
+                        double us;
+                        if (rec.number("elapsed_time_us", us))
+                            elapsed.push_back(us);
+                    }
+                    if (elapsed.size() >= 2)
+                        print_summary(cfg, elapsed, warmup);
+                }
     return 0;
 }
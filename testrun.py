@@ -1,34 +1,117 @@
 import os
+import json
 import subprocess
 import pandas as pd
 
-TEST_CAND_ARR = ["A","B","C","D","E"]
-TEST_TYPE = ["I","II"]
+TEST_CAND_ARR = ["A","B","C","D","E","F","G","H","I"]
+TEST_TYPE = ["I","II","III","IV","V"]
 TEST_ID = ["i","ii","iii","iv","v","vi"]
+TEST_MEM = ["fixed","reserve","thp","hugetlb"]
+TEST_ALLOC = ["new","slab","arena","pool"]
+TEST_SSSP_THREADS = [1,2,4,8,16]
+TEST_MT_THREADS = [1,2,4,8,16]
+TEST_DIST = ["exp","uniform","bimodal","triangular","sawtooth"]
+TEST_FILL = ["random","sorted","reverse"]
+TEST_PAYLOAD = [8,32,64,128]
+TEST_STORE = ["inline","indirect","move"]
+TEST_K = [10,1000,100000,1000000]
+# TEST V only: whole-stream selections the top-k queues are compared against
+TEST_REFERENCES = ["partial_sort","nth_element"]
 RESULT_PATH = "results"
+# every cell: untimed warmup runs, then timed repetitions summarised by median/MAD/95% bootstrap CI
+TEST_WARMUP = 1
+TEST_REPS = 5
+TEST_PIN = ""   # e.g. "2" or "2,3": pin the benchmark to these CPUs
+TRACE_PATH = "traces"
+
+# candidates that only run some test types (default: all of TEST_TYPE)
+CAND_TYPES = {"F": ["II","III","IV","V"], "H": ["I","III"]}
 
 res_path = lambda report : os.path.join(RESULT_PATH,report)
+supports = lambda tcand,ttype : ttype in CAND_TYPES.get(tcand,TEST_TYPE)
 
 def parse_out_to_dict(out,need_s=False,prec=4):
-    ret = {}
+    # testmain prints one JSON object per line, one line per cell
+    rows = []
     for line in out:
-        if line.startswith("[TEST]"):
-            d = eval(line[len("[TEST]"):])
-            ret.update(d)
-    if "elapsed_time_us" in ret:
-        ret["elapsed_time_ms"] = [round(ret["elapsed_time_us"][0]/1000,prec)]
-        if need_s:
-            ret["elapsed_time_s"] = [round(ret["elapsed_time_ms"][0]/1000,prec)]
-    return pd.DataFrame(ret)
-
-def run_test(tcand,ttype,tid,need_s=False):
-    cmd = f"make clean && make run cand={tcand} type={ttype} id={tid}"
+        if not line.startswith("{"):
+            continue
+        ret = json.loads(line)
+        # every *_time_us column (search, graph generation, graph build) gets ms/s variants
+        for key in [k for k in ret if k.endswith("_time_us")]:
+            base = key[:-len("_us")]
+            if isinstance(ret[key],str):
+                continue
+            ret[f"{base}_ms"] = round(ret[key]/1000,prec)
+            if need_s:
+                ret[f"{base}_s"] = round(ret[f"{base}_ms"]/1000,prec)
+        rows.append(ret)
+    return pd.DataFrame(rows)
+
+def rep_args():
+    pin = f" pin={TEST_PIN}" if TEST_PIN else ""
+    return f"warmup={TEST_WARMUP} reps={TEST_REPS}{pin}"
+
+def run_test(tcand,ttype,tid,need_s=False,extra=""):
+    # make only rebuilds testmain when the build-time knobs in extra change
+    cmd = f"make run cand={tcand} type={ttype} id={tid} {rep_args()} {extra}".strip()
     print(f"cmd: {cmd}")
     try:
         out = subprocess.check_output(cmd,shell=True).decode('utf-8').split('\n')
         out = parse_out_to_dict(out,need_s)
     except:
-        out = parse_out_to_dict({})
+        out = parse_out_to_dict([])
+    out["variant"] = extra
+    return out
+
+def flag_ci_overlaps(result):
+    # summary rows of one (type, size) cell whose CIs overlap: their difference is noise
+    # (TEST III/IV cells are also keyed by distribution and fill order, TEST IV by payload and store, TEST V by k)
+    result = result.reset_index(drop=True)
+    if "stat" not in result.columns:
+        return result
+    result["ci_overlap"] = ""
+    summary = result[result["stat"]=="summary"]
+    label = lambda r : r["cand"] + (f"[{r['variant']}]" if r["variant"] else "")
+    keys = ["type","size"] + [k for k in ["dist","fill","payload","store","k"] if k in result.columns]
+    for _,group in summary.groupby(keys,dropna=False):
+        for i,row in group.iterrows():
+            others = [label(o) for j,o in group.iterrows()
+                      if j != i and o["elapsed_ci_lo_us"] <= row["elapsed_ci_hi_us"]
+                      and row["elapsed_ci_lo_us"] <= o["elapsed_ci_hi_us"]]
+            result.loc[i,"ci_overlap"] = ",".join(others)
+    flagged = result[result["ci_overlap"] != ""]
+    if len(flagged):
+        print(f"{len(flagged)} summaries overlap another candidate's CI (see ci_overlap)")
+    return result
+
+def add_dk_savings(result):
+    # pushes and stale pops a dk cell did not make, against the lazy cell of the
+    # same candidate and size (the counts are identical across repetitions)
+    result = result.reset_index(drop=True)
+    if "dij" not in result.columns:
+        return result
+    result["pushes_avoided"] = pd.NA
+    result["stale_pops_avoided"] = pd.NA
+    lazy = result[result["dij"]=="lazy"].groupby(["cand","size"])[["pushes","stale_pops"]].first()
+    for i,row in result[result["dij"]=="dk"].iterrows():
+        key = (row["cand"],row["size"])
+        if key in lazy.index:
+            result.loc[i,"pushes_avoided"] = lazy.loc[key,"pushes"] - row["pushes"]
+            result.loc[i,"stale_pops_avoided"] = lazy.loc[key,"stale_pops"] - row["stale_pops"]
+    return result
+
+def run_trace(trace,tcand,need_s=False,extra=""):
+    # replay a recorded op stream (op_trace.h) on the given candidates
+    pin = f" --pin {TEST_PIN}" if TEST_PIN else ""
+    cmd = f"make testmain {extra} && ./testmain --trace {trace} --cand {tcand} --warmup {TEST_WARMUP} --reps {TEST_REPS}{pin}".strip()
+    print(f"cmd: {cmd}")
+    try:
+        out = subprocess.check_output(cmd,shell=True).decode('utf-8').split('\n')
+        out = parse_out_to_dict(out,need_s)
+    except:
+        out = parse_out_to_dict([])
+    out["variant"] = extra
     return out
 
 def test_all():
@@ -37,10 +120,12 @@ def test_all():
     out_arr = []
     for tcand in TEST_CAND_ARR:
         for ttype in TEST_TYPE:
+            if not supports(tcand,ttype):
+                continue
             for tid in TEST_ID:
                 out = run_test(tcand,ttype,tid,need_s=True)
                 out_arr.append(out)
-    result = pd.concat(out_arr)
+    result = flag_ci_overlaps(pd.concat(out_arr))
     result.to_csv(res_path(report_name),index=False)
     print(f"test result is written to {res_path(report_name)}")
     print(f"{func_name} done !!!")
@@ -51,10 +136,12 @@ def test_I():
     out_arr = []
     for tcand in TEST_CAND_ARR:
         ttype = 'I'
+        if not supports(tcand,ttype):
+            continue
         for tid in TEST_ID:
             out = run_test(tcand,ttype,tid,need_s=True)
             out_arr.append(out)
-    result = pd.concat(out_arr)
+    result = flag_ci_overlaps(pd.concat(out_arr))
     result.to_csv(res_path(report_name),index=False)
     print(f"test result is written to {res_path(report_name)}")
     print(f"{func_name} done !!!")
@@ -65,10 +152,61 @@ def test_II():
     out_arr = []
     for tcand in TEST_CAND_ARR:
         ttype = 'II'
+        if not supports(tcand,ttype):
+            continue
         for tid in TEST_ID[:-1]:
             out = run_test(tcand,ttype,tid,need_s=True)
             out_arr.append(out)
-    result = pd.concat(out_arr)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_III():
+    # hold model at a fixed queue size: every increment distribution and fill order, one process per size
+    func_name = "test_III"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    ttype = 'III'
+    cands = ",".join(c for c in TEST_CAND_ARR if supports(c,ttype))
+    for tid in TEST_ID[TEST_ID.index('ii'):-1]:
+        out = run_test(cands,ttype,tid,need_s=True,extra=f"dist={','.join(TEST_DIST)} fill={','.join(TEST_FILL)}")
+        out["variant"] = ""
+        out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_IV():
+    # event simulation: every record size stored inline, behind an index and moved, one process per size
+    func_name = "test_IV"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    ttype = 'IV'
+    cands = ",".join(c for c in TEST_CAND_ARR if supports(c,ttype))
+    payloads = ",".join(str(p) for p in TEST_PAYLOAD)
+    for tid in TEST_ID[TEST_ID.index('ii'):-1]:
+        out = run_test(cands,ttype,tid,need_s=True,extra=f"payload={payloads} store={','.join(TEST_STORE)}")
+        out["variant"] = ""
+        out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_V():
+    # top-k of 1e6..1e8 streamed keys for every k: bounded queues vs partial_sort/nth_element of the buffered stream
+    func_name = "test_V"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    ttype = 'V'
+    cands = ",".join([c for c in TEST_CAND_ARR if supports(c,ttype)] + TEST_REFERENCES)
+    for tid in TEST_ID[TEST_ID.index('iv'):]:
+        out = run_test(cands,ttype,tid,need_s=True,extra=f"k={','.join(str(k) for k in TEST_K)}")
+        out["variant"] = ""
+        out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
     result.to_csv(res_path(report_name),index=False)
     print(f"test result is written to {res_path(report_name)}")
     print(f"{func_name} done !!!")
@@ -79,10 +217,12 @@ def test_simple_I():
     out_arr = []
     for tcand in TEST_CAND_ARR[:]:
         ttype = 'I'
+        if not supports(tcand,ttype):
+            continue
         for tid in TEST_ID[:TEST_ID.index('iv')+1]:
             out = run_test(tcand,ttype,tid)
             out_arr.append(out)
-    result = pd.concat(out_arr)
+    result = flag_ci_overlaps(pd.concat(out_arr))
     result.to_csv(res_path(report_name),index=False)
     print(f"test result is written to {res_path(report_name)}")
     print(f"{func_name} done !!!")
@@ -93,10 +233,197 @@ def test_simple_II():
     out_arr = []
     for tcand in TEST_CAND_ARR[:]:
         ttype = 'II'
+        if not supports(tcand,ttype):
+            continue
         for tid in TEST_ID[:TEST_ID.index('iii')+1]:
             out = run_test(tcand,ttype,tid)
             out_arr.append(out)
-    result = pd.concat(out_arr)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_I_sizes():
+    # fine-grained size scan of TEST I in one process per candidate (cache/TLB transitions)
+    func_name = "test_I_sizes"
+    report_name = f"{func_name}_result.csv"
+    sizes = ",".join(str(int(1000*2**(k/4))) for k in range(0,4*11+1))
+    out_arr = []
+    ttype = 'I'
+    for tcand in TEST_CAND_ARR:
+        if not supports(tcand,ttype):
+            continue
+        out = run_test(tcand,ttype,"",need_s=True,extra=f"size={sizes} reps=3")
+        out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_trace():
+    # record each TEST I op stream once, then replay the same bytes on every candidate
+    func_name = "test_trace"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    os.makedirs(TRACE_PATH,exist_ok=True)
+    for tid in TEST_ID[:TEST_ID.index('v')+1]:
+        trace = os.path.join(TRACE_PATH,f"test_I_{tid}.trace")
+        subprocess.check_call(f"make testmain && ./testmain --record {trace} --id {tid}",shell=True)
+        cands = ",".join(TEST_CAND_ARR)
+        out = run_trace(trace,cands,need_s=True)
+        out["id"] = tid
+        out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_perf():
+    # hardware counters (perf=1) of A vs E from cache-resident to memory-bound sizes, per operation
+    func_name = "test_perf"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    for ttype in TEST_TYPE:
+        for tid in TEST_ID[TEST_ID.index('ii'):]:
+            if ttype == 'II' and tid == TEST_ID[-1]:
+                continue
+            out = run_test("A,E",ttype,tid,need_s=True,extra="perf=1")
+            out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_latency():
+    # per-op latency percentiles (latency=1) of every candidate, TEST I and TEST II
+    func_name = "test_latency"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    for ttype in TEST_TYPE:
+        for tid in TEST_ID[TEST_ID.index('iii'):TEST_ID.index('v')+1]:
+            cands = ",".join(c for c in TEST_CAND_ARR if supports(c,ttype))
+            out = run_test(cands,ttype,tid,need_s=True,extra="latency=1")
+            out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_mem():
+    # memory footprint (memtrack=1): allocations, peak/retained heap bytes and bytes per element, plus peak RSS
+    func_name = "test_mem"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    for ttype in TEST_TYPE:
+        for tid in TEST_ID[TEST_ID.index('iii'):TEST_ID.index('v')+1]:
+            cands = ",".join(c for c in TEST_CAND_ARR if supports(c,ttype))
+            out = run_test(cands,ttype,tid,need_s=True,extra="memtrack=1")
+            out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_E_mem():
+    # fixed aligned new[] vs reserved/committed memory with small, transparent and explicit huge pages
+    func_name = "test_E_mem"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    tcand = 'E'
+    ttype = 'I'
+    for tid in TEST_ID[TEST_ID.index('iv'):]:
+        for mem in TEST_MEM:
+            out = run_test(tcand,ttype,tid,need_s=True,extra=f"mem={mem}")
+            out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_alloc():
+    # node-based candidates on each node memory resource: allocator cost vs data structure cost
+    func_name = "test_alloc"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    for tcand in ["B","C","D"]:
+        for ttype in TEST_TYPE:
+            for tid in TEST_ID[TEST_ID.index('iii'):-1]:
+                for alloc in TEST_ALLOC:
+                    out = run_test(tcand,ttype,tid,need_s=True,extra=f"alloc={alloc}")
+                    out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_I_batch():
+    # element-wise vs bulk push/pop batches in TEST I
+    func_name = "test_I_batch"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    ttype = 'I'
+    for tcand in TEST_CAND_ARR:
+        if not supports(tcand,ttype):
+            continue
+        for tid in TEST_ID[:TEST_ID.index('v')+1]:
+            for batch in [0,1]:
+                out = run_test(tcand,ttype,tid,need_s=True,extra=f"batch={batch}")
+                out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_I_mt():
+    # shared queue under P threads: MultiQueue (H) and lock-free skiplist (I) vs mutex-wrapped
+    # sequential queues, with mixed threads and with split producers/consumers
+    func_name = "test_I_mt"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    ttype = 'I'
+    for tcand in ["A","E","H","I"]:
+        for tid in TEST_ID[TEST_ID.index('iii'):TEST_ID.index('v')+1]:
+            for threads in TEST_MT_THREADS:
+                for split in [0,1]:
+                    out = run_test(tcand,ttype,tid,need_s=True,extra=f"mt={threads} mt_split={split}")
+                    out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_II_dij():
+    # lazy duplicate pushes vs decrease-key frontier in the Dijkstra workload
+    func_name = "test_II_dij"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    ttype = 'II'
+    for tcand in ["B","C","E"]:
+        for tid in TEST_ID[:-1]:
+            for dij in ["lazy","dk"]:
+                out = run_test(tcand,ttype,tid,need_s=True,extra=f"dij={dij}")
+                out_arr.append(out)
+    result = add_dk_savings(flag_ci_overlaps(pd.concat(out_arr)))
+    result.to_csv(res_path(report_name),index=False)
+    print(f"test result is written to {res_path(report_name)}")
+    print(f"{func_name} done !!!")
+
+def test_II_delta():
+    # parallel delta-stepping across thread counts vs the sequential queues (lazy Dijkstra)
+    func_name = "test_II_delta"
+    report_name = f"{func_name}_result.csv"
+    out_arr = []
+    ttype = 'II'
+    for tid in TEST_ID[TEST_ID.index('iii'):-1]:
+        for tcand in TEST_CAND_ARR:
+            if not supports(tcand,ttype):
+                continue
+            out = run_test(tcand,ttype,tid,need_s=True)
+            out_arr.append(out)
+        for threads in TEST_SSSP_THREADS:
+            out = run_test('delta',ttype,tid,need_s=True,extra=f"dij=delta sssp_threads={threads}")
+            out_arr.append(out)
+    result = flag_ci_overlaps(pd.concat(out_arr))
     result.to_csv(res_path(report_name),index=False)
     print(f"test result is written to {res_path(report_name)}")
     print(f"{func_name} done !!!")
@@ -110,7 +437,7 @@ def test_single():
     tid = 'i'
     out = run_test(tcand,ttype,tid)
     out_arr.append(out)
-    result = pd.concat(out_arr)
+    result = flag_ci_overlaps(pd.concat(out_arr))
     result.to_csv(res_path(report_name),index=False)
     print(f"test result is written to {res_path(report_name)}")
     print(f"{func_name} done !!!")